@@ -29,7 +29,12 @@ namespace dsp56k
 			if (moduloMask)
 			{
 				n=signextend<int,24>(n);
-				if( abs(n) >= modulo )	// linear addressing OR modulo with increment exceeding modulo.
+				if (!modulo && moduloMask != 0xffffff)
+				{
+					// multiple wrap-around modulo, the modulo is a power of two and only the bits below it are modified
+					r = (r & ~moduloMask) | ((r + n) & moduloMask);
+				}
+				else if( abs(n) >= modulo )	// linear addressing OR modulo with increment exceeding modulo.
 				{
 					// the doc says it's only valid for N = P x (2 pow k), but assume the assembly is okay
 //						LOG( "r " << std::hex << r << " + n " << std::hex << n << " = " << std::hex << ((r+n)&0x00ffffff) );
@@ -48,13 +53,13 @@ namespace dsp56k
 			}
 			else	// bit-reverse mode
 			{
-				assert( 0 && "bitreverse mode is used" );
+				// reverse-carry: the carry propagates from the MSB towards the LSB. A negative offset is subtracted
+				n=signextend<int,24>(n);
+
+				const TWord rr = bitreverse24(r);
+				const TWord nr = bitreverse24(static_cast<TWord>(abs(n)));
 
-				r = bitreverse24(r);
-				n = bitreverse24(n);
-				r += n;
-				r &= 0x00ffffff;
-				r = bitreverse24(r);
+				r = bitreverse24((n < 0 ? rr - nr : rr + nr) & 0x00ffffff);
 			}
 		}
 	};
@@ -2,6 +2,7 @@
 
 #include "dsp.h"
 
+#include <algorithm>
 #include <iomanip>
 #include <cstring>
 
@@ -112,6 +113,7 @@ namespace dsp56k
 		reg.omr = TReg24(int(0));
 		
 		m_instructions = 0;
+		m_powerMode = PowerNormal;
 	}
 
 	// _____________________________________________________________________________
@@ -124,6 +126,8 @@ namespace dsp56k
 
 		if(g_useJIT)
 		{
+			m_jit.clearInterruptPending();
+
 			if(m_processingMode == Default)
 			{
 				if(m_pendingInterrupts.empty())
@@ -164,6 +168,100 @@ namespace dsp56k
 		}
 	}
 
+	uint32_t DSP::runFor(const uint32_t _instructions)
+	{
+		return runUntil(nullptr, _instructions);
+	}
+
+	uint32_t DSP::runUntil(const std::function<bool()>& _predicate, const uint32_t _maxInstructions)
+	{
+		const auto begin = m_instructions;
+
+		m_idle = false;
+
+		// a polling loop may find out that it is idle any time, see execLowPower
+		m_wakeUpRequested = false;
+
+		while(m_instructions - begin < _maxInstructions)
+		{
+			if(m_powerMode != PowerNormal)
+			{
+				// no instructions are executed until an interrupt arrives, return if nothing is going to raise one
+				if(!execLowPower(_maxInstructions - (m_instructions - begin)))
+					break;
+
+				if(_predicate && _predicate())
+					break;
+				continue;
+			}
+
+			// process interrupts & peripherals
+			exec();
+
+			// execute everything up to the point where peripherals need to be serviced again in one go
+			const uint32_t untilPeriph = peripheralCounter > m_instructions ? peripheralCounter - m_instructions : 0;
+			const uint32_t remaining = _maxInstructions - std::min(_maxInstructions, m_instructions - begin);
+			const uint32_t count = std::min(untilPeriph, remaining);
+
+			if(g_useJIT)
+			{
+				m_jit.execFor(count);
+			}
+			else
+			{
+				const auto end = m_instructions + count;
+				while(static_cast<int32_t>(end - m_instructions) > 0 && m_powerMode == PowerNormal)
+					exec();
+			}
+
+			if(_predicate && _predicate())
+				break;
+		}
+
+		return m_instructions - begin;
+	}
+
+	void DSP::execInterpreted()
+	{
+		// used by the JIT to run single instructions for which no code exists yet. JIT code does not maintain the
+		// lazy state of the interpreter, sync it before and flush it afterwards
+		syncModulo();
+
+		pcCurrentInstruction = reg.pc.toWord();
+
+		const auto op = fetchPC();
+
+		execOp(op);
+
+		updateDirtyCCR();
+	}
+
+	void DSP::execInterpretedOp(const TWord _pc)
+	{
+		// called by JIT code for instructions that the JIT has no implementation for. The block that calls us counts
+		// the instruction, it is not counted here
+		syncModulo();
+
+		reg.pc.var = _pc;
+		pcCurrentInstruction = _pc;
+
+		const auto op = fetchPC();
+
+		m_currentOpLen = 1;
+		exec_jump(m_opcodeCache[_pc].op, op);
+
+		updateDirtyCCR();
+	}
+
+	void DSP::syncModulo()
+	{
+		for(int i=0; i<8; ++i)
+		{
+			if(moduloM[i] != reg.m[i].var)
+				set_m(i, reg.m[i].var);
+		}
+	}
+
 	void DSP::execPeriph()
 	{
 		if (peripheralCounter > m_instructions)
@@ -174,12 +272,99 @@ namespace dsp56k
 		perif[0]->exec();
 	}
 
+	bool DSP::execLowPower(const uint32_t _maxInstructions)
+	{
+		// Cleared before anything is checked, a wakeup that arrives after this point is not lost. A polling loop has
+		// checked the peripheral state before we got here, the flag has been cleared by runUntil before that
+		if(m_powerMode != PowerIdleLoop)
+			m_wakeUpRequested = false;
+
+		// JIT code may have left a polling loop with an interrupt already queued, it needs to be serviced before any
+		// time is skipped. Otherwise the peripheral that raised it would see its event being missed
+		if(!hasUnmaskedPendingInterrupt())
+		{
+			if(m_powerMode != PowerStop)
+			{
+				// Peripherals keep running, emulated time is advanced in one go up to their next event
+				skipToNextPeripheralEvent(_maxInstructions);
+			}
+			else
+			{
+				// The clock is halted, the instruction counter is not advanced so that timers and ESAI do not see any time
+				// passing. Peripherals are still serviced to deliver interrupts caused by the host
+				perif[0]->exec();
+			}
+		}
+
+		// masked interrupts stay in the queue, they do not end WAIT or STOP
+		if(hasUnmaskedPendingInterrupt())
+		{
+			m_powerMode = PowerNormal;
+			return true;
+		}
+
+		if(m_powerMode == PowerIdleLoop)
+		{
+			// the loop needs to check the peripheral state again, either now or once the host has woken us up
+			m_powerMode = PowerNormal;
+			m_idle = perif[0]->isIdle();
+			return !m_idle;
+		}
+
+		m_idle = m_powerMode == PowerStop || perif[0]->isIdle();
+		return !m_idle;
+	}
+
+	void DSP::skipToNextPeripheralEvent(const uint32_t _maxInstructions)
+	{
+		const uint32_t untilPeriph = peripheralCounter > m_instructions ? peripheralCounter - m_instructions : 0;
+		const uint32_t skip = std::min(_maxInstructions, std::max(untilPeriph, perif[0]->getCyclesUntilNextEvent()));
+
+		m_instructions += skip;
+
+		// service them right away if we skipped past the regular interval
+		if(peripheralCounter < m_instructions)
+			peripheralCounter = m_instructions;
+
+		execPeriph();
+	}
+
+	void DSP::sleep()
+	{
+		std::unique_lock<std::mutex> lock(m_wakeUpMutex);
+
+		m_sleeping = true;
+
+		while(!m_wakeUpRequested && !m_terminated)
+			m_wakeUpCondition.wait(lock);
+
+		m_sleeping = false;
+	}
+
+	void DSP::wakeUp()
+	{
+		m_wakeUpRequested = true;
+
+		// only lock if needed, this is called for every interrupt
+		if(!m_sleeping)
+			return;
+
+		std::lock_guard<std::mutex> lock(m_wakeUpMutex);
+		m_wakeUpCondition.notify_one();
+	}
+
 	void DSP::tryExecInterrupts()
 	{
 		if (!m_pendingInterrupts.empty())
 			execInterrupts();
 	}
 
+	bool DSP::hasUnmaskedPendingInterrupt() const
+	{
+		// same rule as execInterrupts
+		return !m_pendingInterrupts.empty() && (mr().var & 0x3) < 3;
+	}
+
 	void DSP::execInterrupts()
 	{
 		// TODO: priority sorting, masking
@@ -275,6 +460,9 @@ namespace dsp56k
 
 	void DSP::terminate()
 	{
+		m_terminated = true;
+		wakeUp();
+
 		for(size_t i=0; i<perif.size(); ++i)
 			perif[i]->terminate();
 	}
@@ -1039,6 +1227,14 @@ namespace dsp56k
 		m_opcodeCache[_offset].op = &DSP::op_ResolveCache;
 	}
 
+	void DSP::notifyProgramMemWrite(const TWord _first, const TWord _count)
+	{
+		const auto end = std::min(_first + _count, static_cast<TWord>(m_opcodeCache.size()));
+
+		for(auto i=_first; i<end; ++i)
+			m_opcodeCache[i].op = &DSP::op_ResolveCache;
+	}
+
 	// _____________________________________________________________________________
 	// memRead
 	//
@@ -1197,6 +1393,7 @@ namespace dsp56k
 	void DSP::set_m( const int which, const TWord val)
 	{
 		reg.m[which].var = val;
+		moduloM[which] = val;
 		if (val == 0xffffff) {
 			modulo[which]=0;
 			moduloMask[which]=0xffffff;
@@ -1214,7 +1411,9 @@ namespace dsp56k
 		}
 		else
 		{
-			LOG_ERR_NOTIMPLEMENTED( "AGU multiple Wrap-Around Modulo Modifier: m=" << HEX(val) );
+			// multiple wrap-around modulo, flagged by a modulo of zero
+			moduloMask[which] = AGU::calcModuloMask(val & 0x7fff);
+			modulo[which] = 0;
 		}
 	}
 
@@ -1247,9 +1446,12 @@ namespace dsp56k
 	{
 //		assert(!m_pendingInterrupts.full());
 		m_pendingInterrupts.push_back(_interruptVectorAddress);
+		m_jit.notifyInterrupt();
 
 		if(m_interruptFunc == &DSP::execNoPendingInterrupts)
 			m_interruptFunc = &DSP::tryExecInterrupts;
+
+		wakeUp();
 	}
 
 	void DSP::clearOpcodeCache()
@@ -1263,6 +1465,12 @@ namespace dsp56k
 		m_opcodeCache[_address].op = &DSP::op_ResolveCache;
 		m_jit.notifyProgramMemWrite(_address);
 	}
+
+	void DSP::clearOpcodeCache(const TWord _first, const TWord _count)
+	{
+		notifyProgramMemWrite(_first, _count);
+		m_jit.notifyProgramMemWrite(_first, _count);
+	}
 	
 	TInstructionFunc DSP::resolvePermutation(const Instruction _inst, const TWord _op)
 	{
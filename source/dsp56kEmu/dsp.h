@@ -9,6 +9,11 @@
 #include "logging.h"
 #include "jit.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
 namespace dsp56k
 {
 	class Memory;
@@ -90,6 +95,14 @@ namespace dsp56k
 			LongInterrupt,
 		};
 
+		enum PowerMode
+		{
+			PowerNormal,
+			PowerWait,					// WAIT: the core is halted, peripherals keep running. Any interrupt resumes execution
+			PowerStop,					// STOP: the core and the peripheral clocks are halted. Any interrupt resumes execution
+			PowerIdleLoop,				// not a hardware state: JIT code polls a peripheral in a loop that can only be left once the peripheral state changed
+		};
+
 		enum TraceMode
 		{
 			Disabled	= 0,
@@ -119,6 +132,15 @@ namespace dsp56k
 		CCRCache						ccrCache;
 
 		ProcessingMode					m_processingMode = Default;
+		PowerMode						m_powerMode = PowerNormal;
+
+		// used to put the host thread to sleep while the DSP is in WAIT or STOP and nothing is going to wake it up
+		std::atomic<bool>				m_idle{false};
+		std::atomic<bool>				m_sleeping{false};
+		std::atomic<bool>				m_wakeUpRequested{false};
+		std::atomic<bool>				m_terminated{false};
+		std::mutex						m_wakeUpMutex;
+		std::condition_variable			m_wakeUpCondition;
 
 		TInterruptFunc					m_interruptFunc = &DSP::execNoPendingInterrupts;
 
@@ -180,9 +202,18 @@ namespace dsp56k
 		TReg24	getPC							() const									{ return reg.pc; }
 
 		void 	exec							();
+
+		// Execute instructions for a whole budget. The predicate is checked whenever peripherals have been serviced.
+		// Both return the number of instructions that have been executed, which may slightly exceed the budget
+		uint32_t	runFor						(uint32_t _instructions);
+		uint32_t	runUntil					(const std::function<bool()>& _predicate, uint32_t _maxInstructions = 0xffffffff);
+
 		void	execPeriph						();
+		bool	execLowPower					(uint32_t _maxInstructions);
+		void	skipToNextPeripheralEvent		(uint32_t _maxInstructions);
 		void	tryExecInterrupts				();
 		void	execInterrupts					();
+		bool	hasUnmaskedPendingInterrupt		() const;
 		void	execDefaultPreventInterrupt		();
 		void	execNoPendingInterrupts			();
 		void	nop								() {}
@@ -219,6 +250,7 @@ namespace dsp56k
 
 		void			clearOpcodeCache				();
 		void			clearOpcodeCache				(TWord _address);
+		void			clearOpcodeCache				(TWord _first, TWord _count);	// call after uploading code to P memory, for example an overlay via DMA or host interface
 
 		void			dumpRegisters					() const;
 		void			dumpRegisters					(std::stringstream& _ss) const;
@@ -233,6 +265,13 @@ namespace dsp56k
 		IPeripherals*	getPeriph						(size_t _index)								{ return perif[_index]; }
 		
 		ProcessingMode getProcessingMode() const		{return m_processingMode;}
+		PowerMode		getPowerMode					() const									{ return m_powerMode; }
+
+		// true if the last call to runFor/runUntil returned early because the DSP is in WAIT or STOP or polls a peripheral
+		// and no peripheral is going to raise an interrupt. The caller should call sleep() outside of any locks
+		bool			isIdle							() const									{ return m_idle; }
+		void			sleep							();
+		void			wakeUp							();
 
 		Jit&			getJit							() { return m_jit; }
 
@@ -260,6 +299,9 @@ namespace dsp56k
 		}
 
 		void 	execOp							(TWord op);
+		void	execInterpreted					();
+		void	execInterpretedOp				(TWord _pc);
+		void	syncModulo						();
 
 		void	exec_jump						(const TInstructionFunc& _func, TWord op);
 		
@@ -608,6 +650,7 @@ namespace dsp56k
 		void	setB			( const TReg56& _src )				{ reg.b = _src; }
 
 		TWord 	moduloMask[8], modulo[8];
+		TWord	moduloM[8];		// M values that moduloMask & modulo have been calculated for. JIT code writes M without updating them
 		void 	set_m			( const int which, const TWord val);
 
 		
@@ -630,6 +673,7 @@ namespace dsp56k
 		// - ALU
 		void	alu_and				( bool ab, TWord   _val );
 		void	alu_or				( bool ab, TWord   _val );
+		void	alu_eor				( bool ab, TWord   _val );
 		void	alu_add				( bool ab, const TReg56& _val );
 		void	alu_cmp				( bool ab, const TReg56& _val, bool _magnitude );
 		void	alu_sub				( bool ab, const TReg56& _val );
@@ -643,6 +687,7 @@ namespace dsp56k
 		void	alu_addr			(bool ab);
 
 		void	alu_rol				(bool ab);
+		void	alu_ror				(bool ab);
 
 		void	alu_clr				(bool ab);
 		
@@ -672,6 +717,7 @@ namespace dsp56k
 		bool	memWritePeriphFFFFC0( EMemArea _area, TWord _offset, TWord _value );
 
 		void	notifyProgramMemWrite(TWord _offset);
+		void	notifyProgramMemWrite(TWord _first, TWord _count);
 		
 		TWord	memRead				( EMemArea _area, TWord _offset ) const;
 		void	memReadOpcode		( TWord _offset, TWord& _wordA, TWord& _wordB ) const;
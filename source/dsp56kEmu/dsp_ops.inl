@@ -445,7 +445,9 @@ namespace dsp56k
 	}
 	inline void DSP::op_Stop(const TWord op)
 	{
-		errNotImplemented("STOP");
+		// The PC already points to the next instruction, execution continues there once an interrupt has been processed.
+		// We do not distinguish between interrupt sources, any interrupt ends the STOP state
+		m_powerMode = PowerStop;
 	}
 	inline void DSP::op_Tcc_S1D1(const TWord op)
 	{
@@ -490,7 +492,7 @@ namespace dsp56k
 	}
 	inline void DSP::op_Wait(const TWord op)
 	{
-		errNotImplemented("WAIT");		
+		m_powerMode = PowerWait;
 	}
 	inline void DSP::op_ResolveCache(const TWord op)
 	{
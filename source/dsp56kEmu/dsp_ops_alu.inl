@@ -42,6 +42,22 @@ namespace dsp56k
 		sr_clear( CCR_V );
 	}
 
+	// _____________________________________________________________________________
+	// alu_eor
+	//
+	void DSP::alu_eor( bool ab, TWord _val )
+	{
+		TReg56& d = ab ? reg.b : reg.a;
+
+		d.var ^= (TInt64(_val & 0xffffff)<<24);
+
+		// S L E U N Z V C
+		// v - - - * * * -
+		sr_toggle( CCR_N, bittest( d, 47 ) );
+		sr_toggle( CCR_Z, (d.var & 0xffffff000000) == 0 );
+		sr_clear( CCR_V );
+	}
+
 	// _____________________________________________________________________________
 	// alu_add
 	//
@@ -303,6 +319,24 @@ namespace dsp56k
 		sr_toggle(CCRB_C, c);								// Set if bit 47 of the destination operand is set, and cleared otherwise
 	}
 
+	void DSP::alu_ror(const bool ab)
+	{
+		auto& d = ab ? reg.b.var : reg.a.var;
+
+		const auto c = bitvalue<uint64_t,24>(d);
+
+		auto shifted = ((d & 0x00ffffff000000) >> 1) & 0x00ffffff000000;
+		shifted |= static_cast<uint64_t>(sr_val(CCRB_C)) << 47;
+
+		d &= 0xff000000ffffff;
+		d |= shifted;
+
+		sr_toggle(CCRB_N, bitvalue<uint64_t, 47>(shifted));	// Set if bit 47 of the result is set
+		sr_toggle(CCR_Z, shifted == 0);						// Set if bits 47-24 of the result are 0
+		sr_clear(CCR_V);									// This bit is always cleared
+		sr_toggle(CCRB_C, c);								// Set if bit 24 of the destination operand is set, and cleared otherwise
+	}
+
 	void DSP::alu_clr(bool ab)
 	{
 		auto& dst = ab ? reg.b : reg.a;
@@ -781,16 +815,23 @@ namespace dsp56k
 	}
 	inline void DSP::op_Eor_SD(const TWord op)
 	{
-//		alu_eor(D, decode_JJJ_read_24(JJJ, !D).var);
-		errNotImplemented("EOR");
+		const auto D = getFieldValue<Eor_SD, Field_d>(op);
+		const auto JJ = getFieldValue<Eor_SD, Field_JJ>(op);
+		alu_eor(D, decode_JJ_read(JJ).var);
 	}
 	inline void DSP::op_Eor_xx(const TWord op)
 	{
-		errNotImplemented("EOR");		
+		const auto ab		= getFieldValue<Eor_xx,Field_d>(op);
+		const TWord xxxx	= getFieldValue<Eor_xx,Field_iiiiii>(op);
+
+		alu_eor(ab, xxxx);
 	}
 	inline void DSP::op_Eor_xxxx(const TWord op)
 	{
-		errNotImplemented("EOR");
+		const auto ab = getFieldValue<Eor_xxxx,Field_d>(op);
+		const TWord xxxx = immediateDataExt<Eor_xxxx>();
+
+		alu_eor(ab, xxxx);
 	}
 	inline void DSP::op_Extract_S1S2(const TWord op)
 	{
@@ -1034,11 +1075,17 @@ namespace dsp56k
 	}
 	inline void DSP::op_Or_xx(const TWord op)
 	{
-		errNotImplemented("OR");
+		const auto ab		= getFieldValue<Or_xx,Field_d>(op);
+		const TWord xxxx	= getFieldValue<Or_xx,Field_iiiiii>(op);
+
+		alu_or(ab, xxxx);
 	}
 	inline void DSP::op_Or_xxxx(const TWord op)
 	{
-		errNotImplemented("OR");
+		const auto ab = getFieldValue<Or_xxxx,Field_d>(op);
+		const TWord xxxx = immediateDataExt<Or_xxxx>();
+
+		alu_or(ab, xxxx);
 	}
 	inline void DSP::op_Ori(const TWord op)
 	{
@@ -1065,7 +1112,8 @@ namespace dsp56k
 	}
 	inline void DSP::op_Ror(const TWord op)
 	{
-		errNotImplemented("ROR");
+		const auto D = getFieldValue<Ror, Field_d>(op);
+		alu_ror(D);
 	}
 	inline void DSP::op_Sbc(const TWord op)
 	{
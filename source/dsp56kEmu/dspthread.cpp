@@ -42,7 +42,6 @@ namespace dsp56k
 		::SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
 #endif
 		size_t instructions = 0;
-		size_t counter = 0;
 
 		using Clock = std::chrono::high_resolution_clock;
 
@@ -58,25 +57,14 @@ namespace dsp56k
 			{
 				Guard g(m_mutex);
 
-				const auto iBegin = m_dsp.getInstructionCounter();
-
-				for(size_t i=0; i<128; i += 8)
-				{
-					m_dsp.exec();
-					m_dsp.exec();
-					m_dsp.exec();
-					m_dsp.exec();
-					m_dsp.exec();
-					m_dsp.exec();
-					m_dsp.exec();
-					m_dsp.exec();
-				}
-
-				instructions += m_dsp.getInstructionCounter() - iBegin;
-				counter += 128;
+				instructions += m_dsp.runFor(1024);
 			}
 
-			if((counter & (ipsStep-1)) == 0)
+			// the DSP executed WAIT or STOP and nothing but the host can wake it up
+			if(m_dsp.isIdle())
+				m_dsp.sleep();
+
+			if(instructions >= ipsStep)
 			{
 				const auto t2 = Clock::now();
 				const auto d = t2 - t;
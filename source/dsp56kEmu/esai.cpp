@@ -1,5 +1,7 @@
 #include "esai.h"
 
+#include <limits>
+
 #include "dsp.h"
 #include "interrupts.h"
 #include "peripherals.h"
@@ -41,6 +43,17 @@ namespace dsp56k
 		m_hasReadStatus = 0;
 	}
 
+	uint32_t Esai::getCyclesUntilNextEvent() const
+	{
+		if(!isTransmitterEnabled())
+			return std::numeric_limits<uint32_t>::max();
+
+		// cycles that passed since the last exec() have not been accounted yet
+		const auto elapsed = m_cyclesSinceWrite + delta(m_periph.getDSP().getInstructionCounter(), m_lastClock);
+
+		return elapsed > m_cyclesPerSample ? 0 : m_cyclesPerSample - elapsed + 1;
+	}
+
 	void Esai::updatePCTL(TWord _val)
 	{
 		const TWord pctl = _val;
@@ -293,6 +293,9 @@ namespace dsp56k
 
 		void terminate();
 
+		bool isTransmitterEnabled() const			{ return (m_tcr & M_TEM) != 0; }
+		uint32_t getCyclesUntilNextEvent() const;
+
 	private:
 		bool inputEnabled(uint32_t _index) const	{ return m_rcr.test(static_cast<RcrBits>(_index)); }
 		bool outputEnabled(uint32_t _index) const	{ return m_tcr.test(static_cast<TcrBits>(_index)); }
@@ -41,6 +41,7 @@ namespace dsp56k
 				++m_pendingRXInterrupts;
 			}
 		}
+		m_periph.getDSP().wakeUp();
 	}
 
 	void HDI08::clearRX()
@@ -53,6 +54,7 @@ namespace dsp56k
 		dsp56k::bitset<TWord, HSR_HF0>(m_hsr, _flag0);
 		dsp56k::bitset<TWord, HSR_HF1>(m_hsr, _flag1);
 		LOG("Write HostFlags, HSR " << HEX(m_hsr));
+		m_periph.getDSP().wakeUp();
 	}
 
 	bool HDI08::dataRXFull() const
@@ -60,6 +62,14 @@ namespace dsp56k
 		return m_data.full();
 	}
 
+	bool HDI08::hasPendingInterrupts() const
+	{
+		if (!bittest(m_hpcr, HPCR_HEN))
+			return false;
+
+		return (m_pendingRXInterrupts > 0 && bittest(m_hcr, HCR_HRIE)) || (m_pendingTXInterrupts > 0 && bittest(m_hcr, HCR_HTIE));
+	}
+
 	void HDI08::terminate()
 	{
 		while(!m_data.full())
@@ -93,6 +93,7 @@ namespace dsp56k
 		void reset() {}
 
 		bool dataRXFull() const;
+		bool hasPendingInterrupts() const;
 
 		void terminate();
 
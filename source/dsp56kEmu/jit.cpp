@@ -1,12 +1,18 @@
 #include "jit.h"
 
 #include "dsp.h"
+#include "interrupts.h"
 #include "jitblock.h"
 #include "jithelper.h"
 #include "jitops.h"
+#include "opcodes.h"
 
 #include "asmjit/core/jitruntime.h"
 
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
 #ifdef DSP56K_USE_VTUNE_JIT_PROFILING_API
 #include "../vtuneSdk/include/jitprofiling.h"
 #endif
@@ -16,6 +22,28 @@ using namespace asmjit;
 namespace dsp56k
 {
 	constexpr bool g_traceOps = false;
+	constexpr TWord g_maxAsyncBlockSize = 1024;	// P words that are copied for a block that is compiled on the compile thread
+
+	struct Jit::CompileRequest
+	{
+		TWord pc = g_pcInvalid;
+		TWord pcMax = g_pcInvalid;
+		JitBlock::EmitContext ctx;
+		uint32_t pMemWriteCount = 0;
+		uint32_t codePageCount = 0;
+		JitBlock* block = nullptr;
+	};
+
+	struct Jit::CacheFileEntry
+	{
+		TWord pc;
+		TWord size;
+		TWord la;
+		TWord loopStart;
+		uint64_t hash;	// covers the block range and all fragments
+		std::vector<JitBlock::Fragment> fragments;
+		std::vector<JitBlock::DecodedOp> decodedOps;
+	};
 
 	void funcCreate(Jit* _jit, TWord _pc, JitBlock* _block)
 	{
@@ -47,59 +75,195 @@ namespace dsp56k
 		_jit->run(_pc, _block);
 	}
 
-	Jit::Jit(DSP& _dsp) : m_dsp(_dsp)
+	void funcInterpret(Jit* _jit, TWord _pc, JitBlock* _block)
 	{
-		m_jitCache.resize(_dsp.memory().size(), JitCacheEntry{&funcCreate, nullptr});
+		_jit->interpret(_pc, _block);
+	}
 
+	Jit::Jit(DSP& _dsp) : m_dsp(_dsp), m_jitCache(_dsp.memory().size(), &funcCreate)
+	{
 		m_rt = new JitRuntime();
 	}
 
 	Jit::~Jit()
 	{
-		for(size_t i=0; i<m_jitCache.size(); ++i)
+		stopCompileThread();
+
+		destroyAll();
+
+		if(m_pinnedEntry)
+			m_rt->release(m_pinnedEntry);
+
+		delete m_rt;
+	}
+
+	void Jit::destroyAll()
+	{
+		for(size_t p=0; p<m_jitCache.getPageCount(); ++p)
 		{
-			auto& e = m_jitCache[i];
+			if(!m_jitCache.isPageAllocated(p))
+				continue;
 
-			if(e.block)
-				destroy(e.block);
+			const auto first = static_cast<TWord>(p << JitCache::PageBits);
 
-			for(auto it = e.singleOpCache.begin(); it != e.singleOpCache.end(); ++it)
+			for(TWord i=first; i<first + JitCache::PageSize; ++i)
 			{
-				m_rt->release(it->second->getFunc());
-				delete it->second;
+				if(auto* b = m_jitCache.getBlock(i))
+					destroy(b);
 			}
-			e.singleOpCache.clear();
 		}
 
-		m_jitCache.clear();
+		auto& singleOpCache = m_jitCache.getSingleOpCache();
 
-		delete m_rt;
+		for(auto it = singleOpCache.begin(); it != singleOpCache.end(); ++it)
+			release(it->second);
+		singleOpCache.clear();
 	}
 
 	void Jit::exec(const TWord pc)
 	{
 //		LOG("Exec @ " << HEX(pc));
 
+		if(m_hasCompileResults)
+			installCompiled();
+
 		// get JIT code
 		auto& cacheEntry = m_jitCache[pc];
+		m_runtimeData.m_executedInstructionCount = 0;
 		exec(pc, cacheEntry);
 
 		if(!g_traceOps)
 			m_dsp.m_instructions += m_runtimeData.m_executedInstructionCount;
 	}
 
+	uint32_t Jit::execFor(const uint32_t _instructions)
+	{
+		// Instruction counts of blocks are accumulated locally and added to the DSP when we are done. The interpreter
+		// increments the DSP instruction counter on its own
+		const auto begin = m_dsp.m_instructions;
+		uint32_t count = 0;
+
+		const auto& pendingInterrupts = m_dsp.m_pendingInterrupts;
+		auto& processingMode = m_dsp.m_processingMode;
+
+		while(count + (m_dsp.m_instructions - begin) < _instructions)
+		{
+			// WAIT or STOP have been executed or a polling loop has been found, the DSP advances time on its own
+			if(m_dsp.m_powerMode != DSP::PowerNormal)
+				break;
+
+			// Interrupts are processed here without leaving the batch. JIT code returns to us as soon as an
+			// interrupt has been injected, the fast interrupt is run directly via its precompiled block.
+			// The flag is cleared before the queue is checked, an interrupt that is injected after the check sets it again
+			clearInterruptPending();
+
+			if(processingMode == DSP::DefaultPreventInterrupt)
+				processingMode = DSP::Default;
+			else if(processingMode == DSP::Default && !pendingInterrupts.empty())
+				m_dsp.execInterrupts();
+
+			if(m_hasCompileResults)
+				installCompiled();
+
+			const TWord pc = m_dsp.getPC().var;
+			auto& cacheEntry = m_jitCache[pc];
+			const bool idleLoop = cacheEntry.block && (cacheEntry.block->getFlags() & JitBlock::IdleLoop) && cacheEntry.block->getPCFirst() == pc;
+			m_runtimeData.m_executedInstructionCount = 0;
+			exec(pc, cacheEntry);
+
+			if(!g_traceOps)
+				count += m_runtimeData.m_executedInstructionCount;
+
+			// The block polled a peripheral and jumped to itself. Running it again makes no difference until peripherals
+			// have been serviced, the DSP skips emulated time up to their next event
+			if(idleLoop && m_dsp.getPC().var == pc)
+			{
+				m_dsp.m_powerMode = DSP::PowerIdleLoop;
+				break;
+			}
+		}
+
+		m_dsp.m_instructions += count;
+
+		return m_dsp.m_instructions - begin;
+	}
+
 	void Jit::exec(const TWord pc, JitCacheEntry& e)
 	{
-		e.func(this, pc, e.block);
+		++m_runtimeData.m_epoch;
+
+		if(m_pinDspRegs && e.block && e.func == e.block->getFunc())
+			runBlock(pc, e.block);
+		else
+			e.func(this, pc, e.block);
+
+		if(m_runtimeData.m_aguGuardFailed != g_pcInvalid)
+			onAguGuardFailed();
+	}
+
+	void Jit::onAguGuardFailed()
+	{
+		// A block has been generated for M register values that did not match at runtime. It did not execute anything,
+		// we generate it again with generic AGU code. We do not try again to prevent switching back and forth
+		const auto pc = m_runtimeData.m_aguGuardFailed;
+		m_runtimeData.m_aguGuardFailed = g_pcInvalid;
+
+		m_noAguSpecialization.insert(pc);
+		destroy(pc);
+	}
+
+	void Jit::runBlock(const TWord _pc, JitBlock* _block)
+	{
+		if(m_pinDspRegs)
+			m_pinnedEntry(this, _pc, _block, _block->getFunc());
+		else
+			_block->getFunc()(this, _pc, _block);
 	}
 
 	void Jit::notifyProgramMemWrite(TWord _offset)
 	{
-		destroy(_offset);
+		notifyProgramMemWrite(_offset, 1);
+	}
+
+	void Jit::notifyProgramMemWrite(const TWord _first, const TWord _count)
+	{
+		++m_pMemWriteCount;
+
+		const auto end = std::min(_first + _count, static_cast<TWord>(m_jitCache.size()));
+
+		for(auto i=_first; i<end; ++i)
+		{
+			// nothing to invalidate in pages that never contained any code
+			if(!m_jitCache.isCode(i))
+			{
+				i |= JitCache::CodePageSize - 1;
+				continue;
+			}
+
+			if(m_jitCache.getBlock(i) || m_fragmentBlocks.find(i) != m_fragmentBlocks.end())
+				m_stats.addPMemWriteInvalidation();
+
+			// new code gets a new chance to use specialized AGU code
+			m_executionCounts.erase(i);
+			m_noAguSpecialization.erase(i);
+			destroy(i);
+		}
 	}
 
 	void Jit::emit(const TWord _pc)
 	{
+		CompileRequest r;
+		initRequest(r, _pc);
+
+		if(auto* b = compile(r))
+			install(b);
+	}
+
+	JitBlock* Jit::compile(const CompileRequest& _request)
+	{
+		// Must not access the JIT cache or any DSP state, this may run on the compile thread
+		const auto t0 = std::chrono::steady_clock::now();
+
 		AsmJitLogger logger;
 		AsmJitErrorHandler errorHandler;
 		CodeHolder code;
@@ -112,11 +276,11 @@ namespace dsp56k
 
 		auto* b = new JitBlock(m_asm, m_dsp, m_runtimeData);
 
-		if(!b->emit(_pc, m_jitCache, m_volatileP))
+		if(!b->emit(_request.pc, _request.pcMax, _request.ctx))
 		{
-			LOG("FATAL: code generation failed for PC " << HEX(_pc));
+			LOG("FATAL: code generation failed for PC " << HEX(_request.pc));
 			delete b;
-			return;
+			return nullptr;
 		}
 
 		m_asm.ret();
@@ -131,23 +295,86 @@ namespace dsp56k
 		{
 			const auto* const errString = DebugUtils::errorAsString(err);
 			LOG("JIT failed: " << err << " - " << errString);
-			return;
+			delete b;
+			return nullptr;
 		}
 
-		b->setFunc(func);
+		b->setFunc(func, code.codeSize());
+
+		const auto t1 = std::chrono::steady_clock::now();
+		m_stats.addCompiledBlock(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count()));
+
+		return b;
+	}
+
+	void Jit::initRequest(CompileRequest& _request, const TWord _pc) const
+	{
+		const auto& r = m_dsp.regs();
+
+		_request.pc = _pc;
+		_request.pcMax = getPCMax(_pc);
+		_request.ctx.la = static_cast<TWord>(r.la.var);
+		_request.ctx.loopStart = (r.sr.var & SR_LF) ? static_cast<TWord>(hiword(r.ss[r.sp.var & 0xf]).var) : g_pcInvalid;
+		_request.ctx.volatileP = m_volatileP;
+		_request.ctx.pinDspRegs = m_pinDspRegs;
+		_request.ctx.specializeAgu = m_noAguSpecialization.find(_pc) == m_noAguSpecialization.end();
+		for(size_t i=0; i<_request.ctx.m.size(); ++i)
+			_request.ctx.m[i] = static_cast<TWord>(r.m[i].var);
+		_request.ctx.codePages = m_jitCache.getCodePages();
+		_request.pMemWriteCount = m_pMemWriteCount;
+		_request.codePageCount = m_jitCache.getCodePageCount();
+	}
+
+	TWord Jit::getPCMax(const TWord _pc) const
+	{
+		// for a volatile P address, generate this one op only
+		if(m_volatileP.find(_pc) != m_volatileP.end())
+			return _pc + 1;
+
+		// do never overwrite code that already exists and stop in front of volatile P addresses
+		auto pcMax = m_jitCache.findNextBlock(_pc);
 
-		const auto first = b->getPCFirst();
-		const auto last = first + b->getPMemSize();
+		const auto it = m_volatileP.upper_bound(_pc);
+
+		if(it != m_volatileP.end() && *it < pcMax)
+			pcMax = *it;
+
+		return pcMax;
+	}
+
+	void Jit::install(JitBlock* _block)
+	{
+		const auto first = _block->getPCFirst();
+		const auto last = first + _block->getPMemSize();
+
+		m_jitCache.addBlockStart(first);
 
 		for(auto i=first; i<last; ++i)
 		{			
-			m_jitCache[i].block = b;
+			m_jitCache[i].block = _block;
 			if(i == first)
 				updateRunFunc(m_jitCache[i]);
 			else
 				m_jitCache[i].func = &funcRecreate;
 		}
 
+		for (const auto& f : _block->getFragments())
+		{
+			for(auto i=f.first; i<f.first + f.size; ++i)
+				m_fragmentBlocks[i].insert(_block);
+		}
+
+		markCode(_block);
+
+		link(_block);
+
+		m_codeSize += _block->getCodeSize();
+		m_stats.addInstalledBlock(_block->getEncodedInstructionCount(), _block->getCodeSize());
+		addToLru(_block);
+
+		if(m_codeBudget && m_codeSize > m_codeBudget)
+			evict(_block);
+
 #ifdef DSP56K_USE_VTUNE_JIT_PROFILING_API
 		if(iJIT_IsProfilingActive() == iJIT_SAMPLING_ON)
 		{
@@ -156,59 +383,147 @@ namespace dsp56k
 			std::stringstream ss;
 			char temp[64];
 			sprintf(temp, "$%06x-$%06x", first, last-1);
-			if(b->getFlags() & JitBlock::LoopEnd)
+			if(_block->getFlags() & JitBlock::LoopEnd)
 				strcat(temp, " L");
-			if(b->getFlags() & JitBlock::WritePMem)
+			if(_block->getFlags() & JitBlock::WritePMem)
 				strcat(temp, " P");
 			jmethod.method_name = temp;
 			jmethod.class_file_name = const_cast<char*>("dsp56k::Jit");
 			jmethod.source_file_name = __FILE__;
-			jmethod.method_load_address = static_cast<void*>(func);
-			jmethod.method_size = static_cast<unsigned int>(code.codeSize());
+			jmethod.method_load_address = reinterpret_cast<void*>(_block->getFunc());
+			jmethod.method_size = static_cast<unsigned int>(_block->getCodeSize());
 
 			iJIT_NotifyEvent(iJVM_EVENT_TYPE_METHOD_LOAD_FINISHED, &jmethod);
 		}
 #endif
 
-//		LOG("New block generated @ " << HEX(_pc) << " up to " << HEX(_pc + b->getPMemSize() - 1) << ", instruction count " << b->getEncodedInstructionCount() << ", disasm " << b->getDisasm());
+		if(m_perf.isOpen())
+			notifyPerf(_block);
+
+//		LOG("New block generated @ " << HEX(first) << " up to " << HEX(first + _block->getPMemSize() - 1) << ", instruction count " << _block->getEncodedInstructionCount() << ", disasm " << _block->getDisasm());
 	}
 
-	void Jit::destroy(JitBlock* _block)
+	void Jit::destroy(JitBlock* _block, const bool _cacheSingleOp/* = true*/)
 	{
 		const auto first = _block->getPCFirst();
 		const auto last = first + _block->getPMemSize();
 
 //		LOG("Destroying JIT block at PC " << HEX(first) << ", length " << _block->getPMemSize());
 
+		unlink(_block);
+
+		m_lru.erase(_block->getLruPos());
+
+		m_jitCache.removeBlockStart(first);
+
 		for(auto i=first; i<last; ++i)
 		{
 			m_jitCache[i].block = nullptr;
 			m_jitCache[i].func = &funcCreate;
 		}
 
-		if(_block->getPMemSize() == 1)
+		for (const auto& f : _block->getFragments())
 		{
-			// if a 1-word-op, cache it
-			auto& cacheEntry = m_jitCache[first];
-			const auto op = _block->getSingleOpWord();
+			for(auto i=f.first; i<f.first + f.size; ++i)
+			{
+				const auto it = m_fragmentBlocks.find(i);
+				if(it == m_fragmentBlocks.end())
+					continue;
+				it->second.erase(_block);
+				if(it->second.empty())
+					m_fragmentBlocks.erase(it);
+			}
+		}
 
-			if(cacheEntry.singleOpCache.find(op) == cacheEntry.singleOpCache.end())
+		if(_cacheSingleOp && _block->getPMemSize() == 1 && _block->getFragments().empty())
+		{
+			// if a 1-word-op, cache it
+			if(m_jitCache.pushSingleOp(first, _block->getSingleOpWord(), _block))
 			{
 //				LOG("Caching 1-word-op " << HEX(opA) << " at PC " << HEX(first));
-
-				cacheEntry.singleOpCache.insert(std::make_pair(op, _block));
 				return;
 			}
 		}
 
-		m_rt->release(_block->getFunc());
+		release(_block);
+	}
 
+	void Jit::release(JitBlock* _block)
+	{
+		m_codeSize -= _block->getCodeSize();
+		m_stats.removeBlock(_block->getCodeSize());
+		m_rt->release(_block->getFunc());
 		delete _block;
 	}
 
+	void Jit::addToLru(JitBlock* _block)
+	{
+		_block->setLastUsed(m_runtimeData.m_epoch);
+		_block->setLruPos(m_lru.insert(m_lru.end(), _block), m_runtimeData.m_epoch);
+	}
+
+	void Jit::setCodeBudget(const size_t _bytes)
+	{
+		m_codeBudget = _bytes;
+
+		if(m_codeBudget && m_codeSize > m_codeBudget)
+			evict(nullptr);
+	}
+
+	void Jit::evict(const JitBlock* _keep)
+	{
+		// 1-word-ops that are cached for reuse are not in use at all, they go first
+		auto& singleOpCache = m_jitCache.getSingleOpCache();
+
+		for(auto it = singleOpCache.begin(); it != singleOpCache.end(); ++it)
+			release(it->second);
+		singleOpCache.clear();
+
+		// free a quarter of the budget to not run into this again on the next block
+		const auto targetSize = m_codeBudget - (m_codeBudget >> 2);
+
+		if(m_codeSize <= targetSize)
+			return;
+
+		// Blocks are visited from the least recently installed one. A block that has been entered since it has been put
+		// into the list is moved to its end instead, once it is visited again it is evicted as well
+		size_t count = 0;
+
+		for(auto it = m_lru.begin(); it != m_lru.end() && m_codeSize > targetSize;)
+		{
+			auto* b = *it++;
+
+			if(b == _keep)
+				continue;
+
+			if(b->getLastUsed() > b->getLruEpoch())
+			{
+				m_lru.splice(m_lru.end(), m_lru, b->getLruPos());
+				b->setLruEpoch(m_runtimeData.m_epoch);
+				continue;
+			}
+
+			destroy(b, false);
+			++count;
+		}
+
+		m_stats.addEvictedBlocks(count);
+	}
+
 	void Jit::destroy(TWord _pc)
 	{
-		const auto block = m_jitCache[_pc].block;
+		// superblocks that contain code of this address in addition to their own range
+		const auto it = m_fragmentBlocks.find(_pc);
+
+		if(it != m_fragmentBlocks.end())
+		{
+			const auto blocks = it->second;
+
+			for (auto* b : blocks)
+				destroy(b);
+		}
+
+		const auto block = m_jitCache.getBlock(_pc);
 		if(!block)
 			return;
 		destroy(block);
@@ -216,7 +531,7 @@ namespace dsp56k
 
 	void Jit::run(TWord _pc, JitBlock* _block)
 	{
-		_block->getFunc()(this, _pc, _block);
+		runBlock(_pc, _block);
 
 		if(g_traceOps)
 		{
@@ -235,7 +550,8 @@ namespace dsp56k
 
 	void Jit::runCheckPMemWrite(TWord _pc, JitBlock* _block)
 	{
-		m_runtimeData.m_pMemWriteAddress = g_pcInvalid;
+		m_runtimeData.m_pMemWriteFirst = g_pcInvalid;
+		m_runtimeData.m_pMemWriteLast = 0;
 		run(_pc, _block);
 		checkPMemWrite(_pc, _block);
 	}
@@ -249,7 +565,8 @@ namespace dsp56k
 
 	void Jit::runCheckLoopEndAndPMemWrite(TWord _pc, JitBlock* _block)
 	{
-		m_runtimeData.m_pMemWriteAddress = g_pcInvalid;
+		m_runtimeData.m_pMemWriteFirst = g_pcInvalid;
+		m_runtimeData.m_pMemWriteLast = 0;
 		run(_pc, _block);
 		checkPMemWrite(_pc, _block);
 		checkLoopEnd(_pc, _block);
@@ -259,38 +576,611 @@ namespace dsp56k
 	{
 		auto& cacheEntry = m_jitCache[_pc];
 
-		if(m_jitCache[_pc+1].block != nullptr)
+		if(m_jitCache.getBlock(_pc+1) != nullptr)
 		{
 			// we will generate a 1-word op, try to find in single op cache
 			TWord opA;
 			TWord opB;
 			m_dsp.memory().getOpcode(_pc, opA, opB);
 
-			auto it = cacheEntry.singleOpCache.find(opA);
-
-			if(it != cacheEntry.singleOpCache.end())
+			if(auto* b = m_jitCache.popSingleOp(_pc, opA))
 			{
+				m_stats.addSingleOpCacheHit();
 //				LOG("Returning 1-word-op " << HEX(opA) << " at PC " << HEX(_pc));
 				assert(cacheEntry.block == nullptr);
-				cacheEntry.block = it->second;
-				cacheEntry.singleOpCache.erase(it);
+				cacheEntry.block = b;
+				m_jitCache.addBlockStart(_pc);
 				updateRunFunc(cacheEntry);
+				link(cacheEntry.block);
+				addToLru(cacheEntry.block);
 				exec(_pc, cacheEntry);
 				return;
 			}
 		}
+
+		// blocks that are known from a cache file have been hot in a previous run, they do not wait for the threshold
+		if(!m_cacheFileEntries.empty() && createFromCacheFile(_pc))
+			return;
+
+		if((m_compileThread || m_compileThreshold) && _pc >= Vba_End && canInterpret(_pc))
+		{
+			const bool fallthrough = isInterpretedFallthrough(_pc);
+
+			// Code is compiled once its entry PC has been executed often enough. Instructions that we fall through to
+			// while interpreting are not counted, they are part of the block that starts at the entry PC
+			if(m_compileThreshold)
+			{
+				if(fallthrough || ++m_executionCounts[_pc] < m_compileThreshold)
+				{
+					interpret(_pc, nullptr);
+					return;
+				}
+
+				m_executionCounts.erase(_pc);
+			}
+
+			if(m_compileThread)
+			{
+				// do not request a block that is most likely covered by a block that is being compiled right now
+				if(!m_pendingCompileCount || !fallthrough)
+					requestCompile(_pc);
+
+				interpret(_pc, nullptr);
+				return;
+			}
+		}
+
 		emit(_pc);
 		exec(_pc, cacheEntry);
 	}
 
 	void Jit::recreate(const TWord _pc, JitBlock* _block)
 	{
+		if((m_compileThread || m_compileThreshold) && isInterpretedFallthrough(_pc) && canInterpret(_pc))
+		{
+			// we got here by interpreting code that has been compiled in the meantime. Keep on interpreting until
+			// we reach the start of a block instead of throwing it away
+			interpret(_pc, _block);
+			return;
+		}
+
 		// there is code, but the JIT block does not start at the PC position that we want to run. We need to throw the block away and regenerate
 //		LOG("Unable to jump into the middle of a block, destroying existing block & recreating from " << HEX(pc));
+		m_stats.addRecreate();
 		destroy(_block);
 		create(_pc, _block);
 	}
 
+	void Jit::interpret(const TWord _pc, JitBlock* _block)
+	{
+		m_dsp.execInterpreted();
+
+		// the interpreter counts instructions on its own
+		m_runtimeData.m_executedInstructionCount = 0;
+
+		const TWord nextPC = _pc + m_dsp.m_currentOpLen;
+
+		m_jitCache.markCode(_pc, m_dsp.m_currentOpLen);
+
+		checkLoopEnd(_pc, nullptr);
+
+		m_interpretNextPC = static_cast<TWord>(m_dsp.getPC().var) == nextPC ? nextPC : g_pcInvalid;
+		m_interpretInstructions = m_dsp.m_instructions;
+	}
+
+	void Jit::interpretOp(const TWord _pc)
+	{
+		m_dsp.execInterpretedOp(_pc);
+	}
+
+	bool Jit::isInterpretedFallthrough(const TWord _pc) const
+	{
+		return _pc == m_interpretNextPC && m_dsp.m_instructions == m_interpretInstructions;
+	}
+
+	bool Jit::canInterpret(const TWord _pc) const
+	{
+		// The interpreter executes loops recursively until they are finished, these are always compiled
+		TWord opA;
+		TWord opB;
+		m_dsp.memory().getOpcode(_pc, opA, opB);
+
+		if(!Opcodes::isNonParallelOpcode(opA))
+			return true;
+
+		const auto* oi = m_dsp.opcodes().findNonParallelOpcodeInfo(opA);
+
+		return oi && !oi->flag(OpFlagLoop);
+	}
+
+	void Jit::setPinDspRegs(const bool _enable)
+	{
+		if(_enable == m_pinDspRegs)
+			return;
+
+		// code that has been generated for one mode cannot be mixed with code of the other mode
+		destroyAll();
+
+		if(_enable && !m_pinnedEntry)
+			createPinnedEntry();
+
+		m_pinDspRegs = _enable && m_pinnedEntry;
+	}
+
+	void Jit::createPinnedEntry()
+	{
+		AsmJitErrorHandler errorHandler;
+		CodeHolder code;
+
+		code.setErrorHandler(&errorHandler);
+		code.init(m_rt->environment());
+
+		JitEmitter a(&code);
+
+		constexpr auto pinnedCount = sizeof(g_dspPinnedGps) / sizeof(g_dspPinnedGps[0]);
+
+#ifdef HAVE_ARM64
+		a.push(JitReg64(30));
+#endif
+		for (const auto& gp : g_dspPinnedGps)
+			a.push(gp);
+
+#ifndef HAVE_ARM64
+		// keep the stack aligned to 16 bytes, the return address has been pushed by our caller
+#ifdef _MSC_VER
+		constexpr size_t shadowSpace = 32;
+#else
+		constexpr size_t shadowSpace = 0;
+#endif
+		constexpr size_t stackOffset = ((pinnedCount + 1) & 1) * 8 + shadowSpace;
+		if(stackOffset)
+			a.sub(asmjit::x86::rsp, asmjit::Imm(stackOffset));
+#endif
+
+		JitDspRegPool::loadPinned(a, m_dsp, regPinnedScratch);
+
+#ifdef HAVE_ARM64
+		a.blr(g_funcArgGPs[3]);
+#else
+		a.call(g_funcArgGPs[3]);
+#endif
+
+		JitDspRegPool::storePinned(a, m_dsp, regPinnedScratch);
+
+#ifndef HAVE_ARM64
+		if(stackOffset)
+			a.add(asmjit::x86::rsp, asmjit::Imm(stackOffset));
+#endif
+
+		for(size_t i=pinnedCount; i>0; --i)
+			a.pop(g_dspPinnedGps[i-1]);
+
+#ifdef HAVE_ARM64
+		a.pop(JitReg64(30));
+#endif
+		a.ret();
+
+		a.finalize();
+
+		const auto err = m_rt->add(&m_pinnedEntry, &code);
+
+		if(err)
+		{
+			const auto* const errString = DebugUtils::errorAsString(err);
+			LOG("JIT failed to create entry for pinned registers: " << err << " - " << errString);
+			m_pinnedEntry = nullptr;
+		}
+	}
+
+	namespace
+	{
+		constexpr uint32_t g_cacheFileMagic = 0x4a353644;	// "D65J"
+		constexpr uint32_t g_cacheFileVersion = 2;
+		constexpr uint64_t g_hashInit = 0xcbf29ce484222325ull;
+
+		template<typename T> void write(std::ofstream& _out, const T& _value)
+		{
+			_out.write(reinterpret_cast<const char*>(&_value), sizeof(_value));
+		}
+
+		template<typename T> bool read(std::ifstream& _in, T& _value)
+		{
+			_in.read(reinterpret_cast<char*>(&_value), sizeof(_value));
+			return _in.good();
+		}
+
+		bool isValidRange(const TWord _first, const TWord _size, const size_t _memSize)
+		{
+			return _size > 0 && static_cast<uint64_t>(_first) + _size <= _memSize;
+		}
+	}
+
+	uint64_t Jit::hashPMem(const TWord _first, const TWord _size, uint64_t _hash) const
+	{
+		// FNV-1a
+		for(TWord i=_first; i<_first + _size; ++i)
+		{
+			_hash ^= m_dsp.memory().get(MemArea_P, i);
+			_hash *= 0x100000001b3ull;
+		}
+
+		return _hash;
+	}
+
+	bool Jit::saveCache(const std::string& _filename) const
+	{
+		std::ofstream out(_filename, std::ios::binary | std::ios::trunc);
+
+		if(!out.is_open())
+			return false;
+
+		std::vector<CacheFileEntry> entries;
+
+		for(size_t p=0; p<m_jitCache.getPageCount(); ++p)
+		{
+			if(!m_jitCache.isPageAllocated(p))
+				continue;
+
+			const auto first = static_cast<TWord>(p << JitCache::PageBits);
+
+			for(TWord i=first; i<first + JitCache::PageSize; ++i)
+			{
+				const auto* b = m_jitCache.getBlock(i);
+
+				if(!b || b->getPCFirst() != i)
+					continue;
+
+				CacheFileEntry e{i, b->getPMemSize(), b->getEmitLA(), b->getEmitLoopStart(), 0, b->getFragments(), b->getDecodedOps()};
+
+				e.hash = hashPMem(e.pc, e.size, g_hashInit);
+				for (const auto& f : e.fragments)
+					e.hash = hashPMem(f.first, f.size, e.hash);
+
+				entries.push_back(std::move(e));
+			}
+		}
+
+		write(out, g_cacheFileMagic);
+		write(out, g_cacheFileVersion);
+		write(out, static_cast<uint32_t>(m_dsp.memory().size()));
+		write(out, static_cast<uint32_t>(entries.size()));
+
+		for (const auto& e : entries)
+		{
+			write(out, e.pc);
+			write(out, e.size);
+			write(out, e.la);
+			write(out, e.loopStart);
+			write(out, e.hash);
+
+			write(out, static_cast<uint32_t>(e.fragments.size()));
+
+			for (const auto& f : e.fragments)
+			{
+				write(out, f.first);
+				write(out, f.size);
+			}
+
+			write(out, static_cast<uint32_t>(e.decodedOps.size()));
+
+			for (const auto& d : e.decodedOps)
+			{
+				write(out, d.pc);
+				write(out, d.op);
+				write(out, static_cast<uint32_t>(d.inst));
+				write(out, static_cast<uint32_t>(d.alu));
+			}
+		}
+
+		return out.good();
+	}
+
+	bool Jit::loadCache(const std::string& _filename)
+	{
+		std::ifstream in(_filename, std::ios::binary);
+
+		if(!in.is_open())
+			return false;
+
+		uint32_t magic = 0, version = 0, memSize = 0, count = 0;
+
+		if(!read(in, magic) || !read(in, version) || !read(in, memSize) || !read(in, count))
+			return false;
+
+		if(magic != g_cacheFileMagic || version != g_cacheFileVersion || memSize != m_dsp.memory().size())
+		{
+			LOG("JIT cache file " << _filename << " does not match, ignoring it");
+			return false;
+		}
+
+		// blocks do not overlap, there cannot be more than one per P word
+		if(count > memSize)
+		{
+			LOG("JIT cache file " << _filename << " is corrupt, ignoring it");
+			return false;
+		}
+
+		std::vector<CacheFileEntry> entries;
+		entries.resize(count);
+
+		for (auto& e : entries)
+		{
+			if(!read(in, e.pc) || !read(in, e.size) || !read(in, e.la) || !read(in, e.loopStart) || !read(in, e.hash))
+				return false;
+
+			uint32_t fragmentCount;
+
+			if(!read(in, fragmentCount) || !isValidRange(e.pc, e.size, memSize) || fragmentCount > memSize)
+				return false;
+
+			uint64_t totalSize = e.size;
+
+			e.fragments.resize(fragmentCount);
+
+			for (auto& f : e.fragments)
+			{
+				if(!read(in, f.first) || !read(in, f.size) || !isValidRange(f.first, f.size, memSize))
+					return false;
+				totalSize += f.size;
+			}
+
+			uint32_t decodedCount;
+
+			if(!read(in, decodedCount) || decodedCount > totalSize)
+				return false;
+
+			e.decodedOps.resize(decodedCount);
+
+			for (auto& d : e.decodedOps)
+			{
+				uint32_t inst, alu;
+
+				if(!read(in, d.pc) || !read(in, d.op) || !read(in, inst) || !read(in, alu))
+					return false;
+
+				if(inst >= InstructionCount || alu > InstructionCount)
+					return false;
+
+				d.inst = static_cast<Instruction>(inst);
+				d.alu = static_cast<Instruction>(alu);
+			}
+		}
+
+		// Blocks are generated on demand, the entries only remember their boundaries and decoded ops until then
+		std::sort(entries.begin(), entries.end(), [](const CacheFileEntry& _a, const CacheFileEntry& _b)
+		{
+			return _a.pc < _b.pc;
+		});
+
+		m_cacheFileEntries = std::move(entries);
+
+		LOG("Loaded JIT cache file " << _filename << ", " << count << " blocks");
+
+		return true;
+	}
+
+	bool Jit::createFromCacheFile(const TWord _pc)
+	{
+		const auto it = std::lower_bound(m_cacheFileEntries.begin(), m_cacheFileEntries.end(), _pc, [](const CacheFileEntry& _e, const TWord _p)
+		{
+			return _e.pc < _p;
+		});
+
+		if(it == m_cacheFileEntries.end() || it->pc != _pc)
+			return false;
+
+		const auto e = std::move(*it);
+		m_cacheFileEntries.erase(it);
+
+		// the code has changed since the file has been written, it is generated as usual
+		auto hash = hashPMem(e.pc, e.size, g_hashInit);
+		for (const auto& f : e.fragments)
+			hash = hashPMem(f.first, f.size, hash);
+
+		if(hash != e.hash)
+			return false;
+
+		// The loop state is taken from the DSP as we are about to run the block, the block may not grow beyond the
+		// range that it had when the file has been written
+		CompileRequest r;
+		initRequest(r, _pc);
+		r.pcMax = std::min(r.pcMax, e.pc + e.size);
+
+		// decoding is skipped for ops that have been decoded when the file has been written
+		for (const auto& d : e.decodedOps)
+			r.ctx.decodedOps.insert(std::make_pair(d.pc, d));
+
+		if(m_compileThread && _pc >= Vba_End && canInterpret(_pc))
+		{
+			m_jitCache.markCode(_pc, 1);
+			requestCompile(r);
+			interpret(_pc, nullptr);
+			return true;
+		}
+
+		auto* b = compile(r);
+
+		if(!b)
+			return false;
+
+		install(b);
+		exec(_pc, m_jitCache[_pc]);
+		return true;
+	}
+
+	void Jit::setAsyncCompile(const bool _enable)
+	{
+		if(_enable == getAsyncCompile())
+			return;
+
+		if(!_enable)
+		{
+			stopCompileThread();
+			return;
+		}
+
+		m_compileThread.reset(new std::thread([this]
+		{
+			compileThreadFunc();
+		}));
+	}
+
+	void Jit::setCompileThreshold(const uint32_t _executionCount)
+	{
+		m_compileThreshold = _executionCount;
+
+		if(!m_compileThreshold)
+			m_executionCounts.clear();
+	}
+
+	void Jit::requestCompile(const TWord _pc)
+	{
+		// the interpreter runs this op until the block is ready, make sure that writes to its page are not missed
+		m_jitCache.markCode(_pc, 1);
+
+		CompileRequest r;
+		initRequest(r, _pc);
+		requestCompile(r);
+	}
+
+	void Jit::requestCompile(const CompileRequest& _request)
+	{
+		m_jitCache[_request.pc].func = &funcInterpret;
+		++m_pendingCompileCount;
+
+		// The DSP may write P memory while the block is compiled. The compile thread works on a copy of the range the
+		// block may cover, plus the two words that its last op may read beyond it. Writes are detected via m_pMemWriteCount
+		CompileRequest r = _request;
+		r.pcMax = std::min(r.pcMax, r.pc + g_maxAsyncBlockSize);
+
+		const auto memSize = static_cast<TWord>(m_dsp.memory().size());
+
+		r.ctx.pMemFirst = r.pc;
+		r.ctx.pMem.resize(r.pcMax + 2 - r.pc, 0);
+
+		for(auto i=r.pc; i<std::min(r.pcMax + 2, memSize); ++i)
+			r.ctx.pMem[i - r.pc] = m_dsp.memory().get(MemArea_P, i);
+
+		{
+			std::lock_guard<std::mutex> lock(m_compileMutex);
+			m_compileRequests.push_back(std::move(r));
+		}
+
+		m_compileCv.notify_one();
+	}
+
+	void Jit::installCompiled()
+	{
+		std::vector<CompileRequest> results;
+
+		{
+			std::lock_guard<std::mutex> lock(m_compileMutex);
+			std::swap(results, m_compileResults);
+			m_hasCompileResults = false;
+		}
+
+		for (const auto& r : results)
+		{
+			--m_pendingCompileCount;
+
+			auto& e = m_jitCache[r.pc];
+
+			if(e.func == &funcInterpret)
+				e.func = &funcCreate;
+
+			if(!r.block)
+				continue;
+
+			// discard the block if P memory has been written, if other code has been created or if register pinning has changed in the meantime
+			bool valid = r.pMemWriteCount == m_pMemWriteCount && r.ctx.pinDspRegs == m_pinDspRegs;
+
+			// JIT code ignores writes to pages that are not marked as code. The block is only valid if all of its pages were marked
+			// when it was requested. Mark them now, a new request will then succeed
+			if(valid && !isCode(r.block, r.codePageCount))
+			{
+				markCode(r.block);
+				valid = false;
+			}
+
+			const auto last = r.pc + r.block->getPMemSize();
+
+			for(auto i=r.pc; i<last && valid; ++i)
+				valid = m_jitCache.getBlock(i) == nullptr;
+
+			if(!valid)
+			{
+				// has never been installed, does not count towards the code size
+				m_rt->release(r.block->getFunc());
+				delete r.block;
+				continue;
+			}
+
+			install(r.block);
+		}
+	}
+
+	void Jit::compileThreadFunc()
+	{
+		std::vector<CompileRequest> requests;
+
+		while(true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_compileMutex);
+
+				m_compileCv.wait(lock, [this]
+				{
+					return m_compileThreadExit || !m_compileRequests.empty();
+				});
+
+				if(m_compileThreadExit)
+					return;
+
+				std::swap(requests, m_compileRequests);
+			}
+
+			for (auto& r : requests)
+			{
+				r.block = compile(r);
+
+				std::lock_guard<std::mutex> lock(m_compileMutex);
+				m_compileResults.push_back(r);
+				m_hasCompileResults = true;
+			}
+
+			requests.clear();
+		}
+	}
+
+	void Jit::stopCompileThread()
+	{
+		if(!m_compileThread)
+			return;
+
+		{
+			std::lock_guard<std::mutex> lock(m_compileMutex);
+			m_compileThreadExit = true;
+		}
+
+		m_compileCv.notify_one();
+		m_compileThread->join();
+		m_compileThread.reset();
+		m_compileThreadExit = false;
+
+		// drop requests that have not been processed yet, blocks that have been finished can still be used
+		for (const auto& r : m_compileRequests)
+		{
+			auto& e = m_jitCache[r.pc];
+			if(e.func == &funcInterpret)
+				e.func = &funcCreate;
+		}
+
+		m_pendingCompileCount -= static_cast<uint32_t>(m_compileRequests.size());
+		m_compileRequests.clear();
+
+		installCompiled();
+	}
+
 	void Jit::updateRunFunc(JitCacheEntry& e)
 	{
 		const auto f = e.block->getFlags();
@@ -322,17 +1212,123 @@ namespace dsp56k
 
 	void Jit::checkPMemWrite(TWord _pc, JitBlock* _block)
 	{
-		// if JIT code has written to P memory, destroy a JIT block if present at the write location
-		const TWord pMemWriteAddr = _block->pMemWriteAddress();
+		// if JIT code has written to P memory that contains code, destroy all JIT blocks that overlap the written range
+		const TWord first = _block->pMemWriteFirst();
 
-		if (pMemWriteAddr == g_pcInvalid)
+		if (first == g_pcInvalid)
 			return;
 
-		if (m_jitCache[pMemWriteAddr].block)
-			m_volatileP.insert(pMemWriteAddr);
+		const TWord count = _block->pMemWriteLast() - first + 1;
+
+		// code that modifies a single instruction is expected to do so again, the op at that address is always compiled on its own.
+		// Larger ranges are usually overlays that are uploaded once
+		if (count == 1 && (m_jitCache.getBlock(first) || m_fragmentBlocks.find(first) != m_fragmentBlocks.end()))
+			m_volatileP.insert(first);
 
-		notifyProgramMemWrite(_block->pMemWriteAddress());
-		m_dsp.notifyProgramMemWrite(_block->pMemWriteAddress());
+		notifyProgramMemWrite(first, count);
+		m_dsp.notifyProgramMemWrite(first, count);
+	}
+
+	bool Jit::setPerfOutputs(const uint32_t _outputs, const std::string& _jitDumpDir/* = "/tmp"*/)
+	{
+		if(_outputs == JitPerf::None)
+		{
+			m_perf.close();
+			return true;
+		}
+
+		if(!m_perf.open(_outputs, _jitDumpDir))
+			return false;
+
+		for(size_t p=0; p<m_jitCache.getPageCount(); ++p)
+		{
+			if(!m_jitCache.isPageAllocated(p))
+				continue;
+
+			const auto first = static_cast<TWord>(p << JitCache::PageBits);
+
+			for(TWord i=first; i<first + JitCache::PageSize; ++i)
+			{
+				const auto* b = m_jitCache.getBlock(i);
+				if(b && b->getPCFirst() == i)
+					notifyPerf(b);
+			}
+		}
+
+		for (const auto& it : m_jitCache.getSingleOpCache())
+			notifyPerf(it.second);
+
+		return true;
+	}
+
+	void Jit::notifyPerf(const JitBlock* _block)
+	{
+		m_perf.notifyCodeLoad(reinterpret_cast<const void*>(_block->getFunc()), _block->getCodeSize(), getPerfName(_block));
+	}
+
+	std::string Jit::getPerfName(const JitBlock* _block) const
+	{
+		const auto first = _block->getPCFirst();
+		const auto last = first + _block->getPMemSize() - 1;
+
+		char temp[64];
+		snprintf(temp, sizeof(temp), "dsp56k $%06x-$%06x", first, last);
+
+		std::string name(temp);
+
+		if(_block->getFlags() & JitBlock::LoopEnd)
+			name += " L";
+		if(_block->getFlags() & JitBlock::WritePMem)
+			name += " P";
+
+		// name of the function that the block belongs to, if symbols have been loaded
+		const auto& symbols = m_dsp.memory().getSymbols();
+		const auto itArea = symbols.find(g_memAreaNames[MemArea_P]);
+
+		if(itArea == symbols.end() || itArea->second.empty())
+			return name;
+
+		auto it = itArea->second.upper_bound(first);
+
+		if(it == itArea->second.begin())
+			return name;
+
+		--it;
+
+		if(it->second.names.empty())
+			return name;
+
+		name += ' ';
+		name += *it->second.names.begin();
+
+		if(it->first != first)
+		{
+			snprintf(temp, sizeof(temp), "+%x", first - it->first);
+			name += temp;
+		}
+
+		return name;
+	}
+
+	void Jit::markCode(const JitBlock* _block)
+	{
+		m_jitCache.markCode(_block->getPCFirst(), _block->getPMemSize());
+
+		for (const auto& f : _block->getFragments())
+			m_jitCache.markCode(f.first, f.size);
+	}
+
+	bool Jit::isCode(const JitBlock* _block, const uint32_t _codePageCount) const
+	{
+		if(!m_jitCache.isCode(_block->getPCFirst(), _block->getPMemSize(), _codePageCount))
+			return false;
+
+		for (const auto& f : _block->getFragments())
+		{
+			if(!m_jitCache.isCode(f.first, f.size, _codePageCount))
+				return false;
+		}
+		return true;
 	}
 
 	void Jit::checkLoopEnd(TWord _pc, JitBlock* _block)
@@ -342,7 +1338,7 @@ namespace dsp56k
 		{
 			if (m_dsp.getPC().var == m_dsp.regs().la.var + 1)
 			{
-				assert((_block->getFlags() & JitBlock::LoopEnd) != 0);
+				assert(!_block || (_block->getFlags() & JitBlock::LoopEnd) != 0);
 				auto& lc = m_dsp.regs().lc.var;
 				if (lc <= 1)
 				{
@@ -356,4 +1352,93 @@ namespace dsp56k
 			}
 		}
 	}
+
+	void Jit::link(JitBlock* _block)
+	{
+		// link our successors that already exist
+		auto& slots = _block->getChainSlots();
+
+		for(size_t i=0; i<slots.size(); ++i)
+		{
+			if(slots[i].pc == g_pcInvalid)
+				continue;
+			m_chainRequests[slots[i].pc].insert(_block);
+			link(_block, static_cast<TWord>(i));
+		}
+
+		// link all blocks that want to continue with us
+		const auto it = m_chainRequests.find(_block->getPCFirst());
+		if(it == m_chainRequests.end())
+			return;
+
+		for (auto* source : it->second)
+		{
+			auto& sourceSlots = source->getChainSlots();
+
+			for(size_t i=0; i<sourceSlots.size(); ++i)
+			{
+				if(sourceSlots[i].pc == _block->getPCFirst())
+					link(source, static_cast<TWord>(i));
+			}
+		}
+	}
+
+	bool Jit::link(JitBlock* _block, const TWord _slot)
+	{
+		auto& slot = _block->getChainSlots()[_slot];
+
+		if(slot.target || slot.pc < Vba_End)
+			return false;
+
+		if(!m_jitCache.getBlock(slot.pc))
+			return false;
+
+		const auto& e = m_jitCache[slot.pc];
+
+		// only link blocks that start at the requested PC and do not need any additional processing after they ran
+		if(e.block->getPCFirst() != slot.pc || e.func != e.block->getFunc())
+			return false;
+
+		slot.func = e.block->getFunc();
+		slot.target = e.block;
+
+		e.block->getChainSources().insert(_block);
+		return true;
+	}
+
+	void Jit::unlink(JitBlock* _block)
+	{
+		for (auto& slot : _block->getChainSlots())
+		{
+			if(slot.pc == g_pcInvalid)
+				continue;
+
+			const auto it = m_chainRequests.find(slot.pc);
+			if(it != m_chainRequests.end())
+			{
+				it->second.erase(_block);
+				if(it->second.empty())
+					m_chainRequests.erase(it);
+			}
+
+			if(slot.target)
+				slot.target->getChainSources().erase(_block);
+
+			slot.func = nullptr;
+			slot.target = nullptr;
+		}
+
+		for (auto* source : _block->getChainSources())
+		{
+			for (auto& slot : source->getChainSlots())
+			{
+				if(slot.target != _block)
+					continue;
+				slot.func = nullptr;
+				slot.target = nullptr;
+			}
+		}
+
+		_block->getChainSources().clear();
+	}
 }
@@ -1,10 +1,21 @@
 #pragma once
 
-#include "jitcacheentry.h"
+#include "jitcache.h"
+#include "jitperf.h"
+#include "jitstats.h"
 #include "types.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <vector>
 #include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
 
 #include "jitruntimedata.h"
 
@@ -28,7 +39,16 @@ namespace dsp56k
 
 		void exec(TWord pc);
 
+		// Runs blocks and processes interrupts until the given number of instructions has been executed. Returns the
+		// number of instructions executed
+		uint32_t execFor(uint32_t _instructions);
+
 		void notifyProgramMemWrite(TWord _offset);
+		void notifyProgramMemWrite(TWord _first, TWord _count);	// destroys all blocks that overlap the range, use for code uploads
+		// JIT code does not dispatch interrupts itself. It returns to the dispatcher once an interrupt has been injected,
+		// which runs the fast interrupt. The flag needs to be cleared before the pending interrupts are checked
+		void notifyInterrupt() { m_runtimeData.m_interruptPending.store(1, std::memory_order_relaxed); }
+		void clearInterruptPending() { m_runtimeData.m_interruptPending.store(0, std::memory_order_relaxed); }
 
 		void run(TWord _pc, JitBlock* _block);
 		void runCheckPMemWrite(TWord _pc, JitBlock* _block);
@@ -36,25 +56,135 @@ namespace dsp56k
 		void runCheckLoopEndAndPMemWrite(TWord _pc, JitBlock* _block);
 		void create(TWord _pc, JitBlock* _block);
 		void recreate(TWord _pc, JitBlock* _block);
+		void interpret(TWord _pc, JitBlock* _block);
+		void interpretOp(TWord _pc);	// called by JIT code for instructions that the JIT has no implementation for
+
+		// If enabled, blocks are compiled on a background thread. Until a block is ready, its instructions are executed by the interpreter.
+		// Must be called from the thread that runs the DSP
+		void setAsyncCompile(bool _enable);
+		bool getAsyncCompile() const { return m_compileThread != nullptr; }
+
+		// If non-zero, code is interpreted until its entry PC has been executed this many times. Code that runs rarely
+		// is never compiled. Zero compiles everything on first execution
+		void setCompileThreshold(uint32_t _executionCount);
+		uint32_t getCompileThreshold() const { return m_compileThreshold; }
+
+		// If enabled, the most frequently used DSP registers (SR and, depending on the host, X and Y) are kept in host
+		// registers while JIT code runs, including chained blocks. They are written back when JIT code calls C++ code
+		// and when it returns to the dispatcher. Changing this discards all generated code
+		void setPinDspRegs(bool _enable);
+		bool getPinDspRegs() const { return m_pinDspRegs; }
+
+		// Writes the entry PCs and P memory ranges of all generated blocks to a file, together with a hash of the P memory
+		// they cover, the loop state they have been generated for and their decoded instructions. Loading it in a later
+		// run remembers these entries. A block is generated the first time its entry PC is executed (on the compile thread
+		// if enabled) without waiting for the compile threshold and without decoding its instructions again. Entries whose
+		// P memory content has changed by then are skipped. Host code is not stored, it embeds addresses that are only
+		// valid in the current process
+		bool saveCache(const std::string& _filename) const;
+		bool loadCache(const std::string& _filename);
+
+		// Limits the host memory used by generated code. If it is exceeded, the blocks that have not been run for the
+		// longest time are discarded until a quarter of the budget is free again. Zero means unlimited, which is the default
+		void setCodeBudget(size_t _bytes);
+		size_t getCodeBudget() const { return m_codeBudget; }
+		size_t getCodeSize() const { return m_codeSize; }
+
+		// Announces generated blocks to the Linux perf tool, see JitPerf for the outputs. Blocks are named by their P memory
+		// range and the closest preceding P symbol of the loaded OMF file. Blocks that already exist are announced as well
+		bool setPerfOutputs(uint32_t _outputs, const std::string& _jitDumpDir = "/tmp");
+		uint32_t getPerfOutputs() const { return m_perf.getOutputs(); }
+
+		// Counters that describe how the JIT behaves, see JitStats. May be called from any thread while the DSP is running
+		JitStats getStats() const { return m_stats.get(); }
+		void resetStats() { m_stats.reset(); }
 
 	private:
+		struct CompileRequest;
+		struct CacheFileEntry;
+
 		void emit(TWord _pc);
-		void destroy(JitBlock* _block);
+		void install(JitBlock* _block);
+		JitBlock* compile(const CompileRequest& _request);
+		void initRequest(CompileRequest& _request, TWord _pc) const;
+		TWord getPCMax(TWord _pc) const;
+		bool canInterpret(TWord _pc) const;
+		bool isInterpretedFallthrough(TWord _pc) const;
+
+		void requestCompile(TWord _pc);
+		void requestCompile(const CompileRequest& _request);
+		uint64_t hashPMem(TWord _first, TWord _size, uint64_t _hash) const;
+		bool createFromCacheFile(TWord _pc);
+		void installCompiled();
+		void compileThreadFunc();
+		void stopCompileThread();
+
+		void destroy(JitBlock* _block, bool _cacheSingleOp = true);
 		void destroy(TWord _pc);
+		void destroyAll();
+		void release(JitBlock* _block);
+		void addToLru(JitBlock* _block);
+		void evict(const JitBlock* _keep);
 		
 		void exec(TWord pc, JitCacheEntry& e);
+		void onAguGuardFailed();
+		void runBlock(TWord _pc, JitBlock* _block);
+		void createPinnedEntry();
 
 		static void updateRunFunc(JitCacheEntry& e);
 
 		void checkPMemWrite(TWord _pc, JitBlock* _block);
 		void checkLoopEnd(TWord _pc, JitBlock* _block);
 
+		void notifyPerf(const JitBlock* _block);
+		std::string getPerfName(const JitBlock* _block) const;
+
+		void markCode(const JitBlock* _block);
+		bool isCode(const JitBlock* _block, uint32_t _codePageCount) const;
+
+		void link(JitBlock* _block);
+		void unlink(JitBlock* _block);
+		bool link(JitBlock* _block, TWord _slot);
+
 		JitRuntimeData m_runtimeData;
 
 		DSP& m_dsp;
 
 		asmjit::JitRuntime* m_rt = nullptr;
-		std::vector<JitCacheEntry> m_jitCache;
+		JitCache m_jitCache;
 		std::set<TWord> m_volatileP;
+		std::map<TWord, std::set<JitBlock*>> m_chainRequests;	// successor PC => blocks that want to chain to it
+		std::map<TWord, std::set<JitBlock*>> m_fragmentBlocks;	// P address => superblocks that contain its code outside of their own range
+		std::set<TWord> m_noAguSpecialization;					// entry PCs of blocks whose M register values changed at runtime
+
+		size_t m_codeBudget = 0;
+		size_t m_codeSize = 0;		// host code size of all installed blocks, including cached 1-word-ops
+		std::list<JitBlock*> m_lru;	// installed blocks in the order in which they have been installed or found to be in use
+
+		JitPerf m_perf;
+		JitStatsCounters m_stats;
+
+		uint32_t m_pMemWriteCount = 0;			// compiled blocks are discarded if P memory has been written in the meantime
+		TWord m_interpretNextPC = g_pcInvalid;	// PC of the instruction following the last interpreted one if no branch occured
+		uint32_t m_interpretInstructions = 0;
+		uint32_t m_pendingCompileCount = 0;
+
+		uint32_t m_compileThreshold = 0;
+		std::unordered_map<TWord, uint32_t> m_executionCounts;	// entry PC => number of interpreted executions
+
+		std::vector<CacheFileEntry> m_cacheFileEntries;			// read by loadCache and sorted by entry PC, removed once their block is requested
+
+		std::unique_ptr<std::thread> m_compileThread;
+		std::mutex m_compileMutex;
+		std::condition_variable m_compileCv;
+		std::vector<CompileRequest> m_compileRequests;
+		std::vector<CompileRequest> m_compileResults;
+		std::atomic<bool> m_hasCompileResults{false};
+		bool m_compileThreadExit = false;
+
+		typedef void (*TPinnedEntry)(Jit*, TWord, JitBlock*, TJitUpdateFunc);
+
+		bool m_pinDspRegs = false;
+		TPinnedEntry m_pinnedEntry = nullptr;	// loads pinned registers, runs the block given as fourth arg, stores pinned registers
 	};
 }
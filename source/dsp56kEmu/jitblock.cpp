@@ -5,9 +5,50 @@
 #include "jitops.h"
 #include "memory.h"
 
+#include <algorithm>
+
 namespace dsp56k
 {
 	constexpr uint32_t g_maxInstructionsPerBlock = 0;	// set to 1 for debugging/tracing
+	constexpr uint32_t g_maxChainedInstructions = 64;	// return to the dispatcher after this many instructions to let it process peripherals & interrupts
+	constexpr uint32_t g_maxLoopInstructions = 256;		// same for native loops
+	constexpr uint32_t g_maxFollowedJumps = 4;			// max number of unconditional jumps that are followed to form a superblock
+	constexpr uint32_t g_maxCCRLookahead = 16;			// max number of ops that are scanned to find CCR bits that are overwritten before being read
+
+	static bool isSideEffectFreeRead(DSP& _dsp, const EMemArea _area, const TWord _addr)
+	{
+		// plain registers, constants and status registers can be polled. Registers such as receive FIFOs are changed by being read
+		const auto access = _dsp.getPeriph(_area == MemArea_Y ? 1 : 0)->getDirectReadAccess(_addr);
+		return access.ptr || access.isConstant || (access.read && access.pureRead);
+	}
+
+	template<Instruction Inst> static bool isPollPP(DSP& _dsp, const TWord _op)
+	{
+		return isSideEffectFreeRead(_dsp, getFieldValueMemArea<Inst>(_op), getFieldValue<Inst, Field_pppppp>(_op) + 0xffffc0);
+	}
+
+	template<Instruction Inst> static bool isPollQQ(DSP& _dsp, const TWord _op)
+	{
+		return isSideEffectFreeRead(_dsp, getFieldValueMemArea<Inst>(_op), getFieldValue<Inst, Field_qqqqqq>(_op) + 0xffff80);
+	}
+
+	static bool isPeripheralPoll(DSP& _dsp, const Instruction _inst, const TWord _op)
+	{
+		// bit tests of registers in the peripheral address range that do not write anything
+		switch (_inst)
+		{
+		case Jclr_pp:	return isPollPP<Jclr_pp>(_dsp, _op);
+		case Jclr_qq:	return isPollQQ<Jclr_qq>(_dsp, _op);
+		case Jset_pp:	return isPollPP<Jset_pp>(_dsp, _op);
+		case Jset_qq:	return isPollQQ<Jset_qq>(_dsp, _op);
+		case Brclr_pp:	return isPollPP<Brclr_pp>(_dsp, _op);
+		case Brclr_qq:	return isPollQQ<Brclr_qq>(_dsp, _op);
+		case Brset_pp:	return isPollPP<Brset_pp>(_dsp, _op);
+		case Brset_qq:	return isPollQQ<Brset_qq>(_dsp, _op);
+		default:
+			return false;
+		}
+	}
 
 	JitBlock::JitBlock(JitEmitter& _a, DSP& _dsp, JitRuntimeData& _runtimeData)
 	: m_runtimeData(_runtimeData)
@@ -22,20 +63,37 @@ namespace dsp56k
 	{
 	}
 
-	bool JitBlock::emit(const TWord _pc, std::vector<JitCacheEntry>& _cache, const std::set<TWord>& _volatileP)
+	bool JitBlock::emit(const TWord _pc, const TWord _pcMax, const EmitContext& _ctx)
 	{
 		const bool isFastInterrupt = _pc < Vba_End;
 
-		const TWord pcMax = isFastInterrupt ? (_pc + 2) : m_dsp.memory().size();
+		const TWord pcMax = isFastInterrupt ? std::min(_pc + 2, _pcMax) : _pcMax;
 
 		m_pcFirst = _pc;
 		m_pMemSize = 0;
+		m_pinnedDspRegs = _ctx.pinDspRegs;
+		m_emitLA = _ctx.la;
+		m_emitLoopStart = _ctx.loopStart;
+		m_codePages = _ctx.codePages;
+		m_ctx = &_ctx;
 		m_dspAsm.clear();
-		bool shouldEmit = true;
+
+		// AGU guards are inserted here once we know which M registers the code depends on
+		auto* const cursorEntry = m_asm.cursor();
 
 		asmjit::BaseNode* cursorBeforePCUpdate = nullptr;
 		asmjit::BaseNode* cursorAfterPCUpdate = nullptr;
 
+		// If we are at the start of a DO loop, the loop end might be in this block, in which case we loop natively.
+		// As we may jump back to the beginning, everything that might be pushed later needs to be pushed now
+		const bool isLoopBody = !isFastInterrupt && _ctx.loopStart == _pc;
+
+		if(isLoopBody)
+		{
+			m_stack.pushNonVolatiles();
+			m_stack.pushNonVolatileXMMs();
+		}
+
 		if(!isFastInterrupt)
 		{
 			// This code is only used to set the value of the next PC to the default value. Might be overwritten by a branch.
@@ -49,45 +107,86 @@ namespace dsp56k
 		}
 
 		{
+			// chained blocks do not pass the dispatcher, every block marks itself as used when it is entered
 			const RegGP temp(*this);
+			m_mem.mov(temp, m_runtimeData.m_epoch);
+			m_mem.mov(m_lastUsed, temp.get());
+		}
+
+		const auto loopBegin = m_asm.newLabel();
+
+		if(isLoopBody)
+			m_asm.bind(loopBegin);
+
+		{
+			// accumulate as blocks may be chained
+			const RegGP temp(*this);
+			const RegGP count(*this);
 			m_mem.mov(temp, getEncodedInstructionCount());
+			m_mem.mov(count, getExecutedInstructionCount());
+			m_asm.add(r32(temp.get()), r32(count.get()));
 			m_mem.mov(getExecutedInstructionCount(), temp.get());
 		}
 
+		if(_ctx.specializeAgu && !isFastInterrupt)
+		{
+			for(uint32_t i=0; i<m_aguEntryValues.size(); ++i)
+				m_dspRegPool.setConstant(static_cast<JitDspRegPool::DspReg>(JitDspRegPool::DspM0 + i), _ctx.m[i]);
+
+			m_aguEntryValues = _ctx.m;
+			m_aguEntryValid = 0xff;
+		}
+
 		uint32_t opFlags = 0;
 		bool appendLoopCode = false;
+		Instruction lastInstruction = InstructionCount;
 
-		while(shouldEmit)
-		{
-			const auto pc = m_pcFirst + m_pMemSize;
+		TWord pc = m_pcFirst;
 
-			if(pc >= pcMax)
+		while(true)
+		{
+			if(m_fragments.empty())
+			{
+				// pcMax is the start of existing code or a volatile P address
+				if(pc >= pcMax)
+					break;
+			}
+			else if(!canFollow(pc, _ctx))
+			{
 				break;
+			}
 
-			// do never overwrite code that already exists
-			if(_cache[pc].block)
-				break;
+			JitOps ops(*this, isFastInterrupt);
+
+			// Unconditional jumps to a constant address do not need any code, we continue to emit code at the jump target
+			TWord jumpTarget;
+			TWord jumpSize;
 
-			// for a volatile P address, if you have some code, break now. if not, generate this one op, and then return.
-			if (_volatileP.find(pc)!=_volatileP.end())
+			if(!isFastInterrupt && g_maxInstructionsPerBlock == 0 && m_fragments.size() < g_maxFollowedJumps &&
+				ops.getConstantJumpTarget(jumpTarget, jumpSize, pc) && (pc + jumpSize) != _ctx.la + 1 &&
+				(jumpTarget < pc || jumpTarget >= pc + jumpSize) && canFollow(jumpTarget, _ctx))
 			{
-				if (m_encodedInstructionCount) break;
-				else shouldEmit=false;
+				addSize(jumpSize);
+				++m_encodedInstructionCount;
+				m_lastOpSize = jumpSize;
+				m_fragments.push_back({jumpTarget, 0});
+				pc = jumpTarget;
+				continue;
 			}
 
-			JitOps ops(*this, isFastInterrupt);
-
 			if(false)
 			{
 				std::string disasm;
 				TWord opA;
 				TWord opB;
-				m_dsp.memory().getOpcode(pc, opA, opB);
+				getOpcode(pc, opA, opB);
 				m_dsp.disassembler().disassemble(disasm, opA, opB, 0, 0, 0);
 //				LOG(HEX(pc) << ": " << disasm);
 				m_dspAsm += disasm + '\n';
 			}
 
+			ops.setDeadCCRBits(getDeadCCRBits(ops, pc, pcMax, _ctx));
+
 			m_asm.nop();
 			ops.emit(pc);
 			m_asm.nop();
@@ -96,22 +195,24 @@ namespace dsp56k
 			
 			m_singleOpWord = ops.getOpWordA();
 			
-			m_pMemSize += ops.getOpSize();
+			addSize(ops.getOpSize());
+			pc += ops.getOpSize();
 			++m_encodedInstructionCount;
 
 			const auto res = ops.getInstruction();
 			assert(res != InstructionCount);
+			lastInstruction = res;
 
 			m_lastOpSize = ops.getOpSize();
 
 			// always terminate block if loop end has reached
-			if((m_pcFirst + m_pMemSize) == static_cast<TWord>(m_dsp.regs().la.var + 1))
+			if(pc == _ctx.la + 1)
 			{
 				appendLoopCode = true;
 				break;
 			}
 			
-			if(ops.checkResultFlag(JitOps::WritePMem) || ops.checkResultFlag(JitOps::WriteToLA) || ops.checkResultFlag(JitOps::WriteToLC))
+			if(ops.checkResultFlag(JitOps::WritePMem) || ops.checkResultFlag(JitOps::WriteToLA) || ops.checkResultFlag(JitOps::WriteToLC) || ops.checkResultFlag(JitOps::EnterLowPower))
 				break;
 
 			if(res != Parallel)
@@ -136,42 +237,88 @@ namespace dsp56k
 			}
 		}
 
-		m_pcLast = m_pcFirst + m_pMemSize;
+		m_pcLast = pc;
+
+		const bool nativeLoop = appendLoopCode && isLoopBody;
 
-#if 0
-		if(appendLoopCode)	// this block works, but I'm not sure if we want to keep it here as it increases code size, while the code in jit.cpp does the same but exists only once
+		// M registers are verified on block entry only, the loop needs to be left if the body modifies one that is used
+		const bool aguLoopValid = aguEntryValuesUnchanged();
+
+		if(nativeLoop)
 		{
 			const auto end = m_asm.newLabel();
 			const auto decLC = m_asm.newLabel();
+			const auto exitToSS = m_asm.newLabel();
 
+			JitOps ops(*this, isFastInterrupt);
+			ops.updateDirtyCCR();
 			dspRegPool().releaseAll();
-			stack().pushNonVolatiles();
 
-			JitOps ops(*this, isFastInterrupt);
-//			DSPReg lc(*this, JitDspRegPool::DspLC, true, true);
-			m_asm.bt(m_dspRegs.getSR(JitDspRegs::Read), asmjit::Imm(SRB_LF));	// check loop flag
+			// check loop flag
+#ifdef HAVE_ARM64
+			m_asm.bitTest(m_dspRegs.getSR(JitDspRegs::Read), SRB_LF);
+			dspRegPool().releaseAll();
+			m_asm.jz(end);
+#else
+			m_asm.bt(m_dspRegs.getSR(JitDspRegs::Read), asmjit::Imm(SRB_LF));
+			dspRegPool().releaseAll();
 			m_asm.jnc(end);
-			m_asm.cmp(m_dspRegs.getLC(JitDspRegs::Read), asmjit::Imm(1));
+#endif
+
+			// check that we are at the loop end, we might have branched or LA is not what it was at compile time
+			{
+				const RegGP pc(*this);
+				const RegGP la(*this);
+				mem().mov(pc, nextPC());
+				m_dspRegs.getLA(r32(la.get()));
+				dspRegPool().releaseAll();
+				m_asm.inc(r32(la.get()));
+				m_asm.cmp(r32(pc.get()), r32(la.get()));
+				m_asm.jnz(end);
+			}
+
+			m_asm.cmp(r32(m_dspRegs.getLC(JitDspRegs::Read)), asmjit::Imm(2));
 			dspRegPool().releaseAll();
-			m_asm.jg(decLC);
+			m_asm.jge(decLC);
 			ops.do_end();
 			dspRegPool().releaseAll();
 			m_asm.jmp(end);
 
 			m_asm.bind(decLC);
-			m_asm.dec(m_dspRegs.getLC(JitDspRegs::ReadWrite));
+			m_asm.dec(r32(m_dspRegs.getLC(JitDspRegs::ReadWrite)));
+			dspRegPool().releaseAll();
+
 			{
 				const RegGP ss(*this);
 				m_dspRegs.getSS(ss);
 				m_asm.shr(ss, asmjit::Imm(24));
 				m_asm.and_(ss, asmjit::Imm(0xffffff));
+
+				// jump back if the loop starts at the beginning of this block. Return to the dispatcher every now and then to have
+				// peripherals processed or immediately if an interrupt is pending
+				{
+					const RegGP temp(*this);
+					m_asm.mov(r32(temp.get()), asmjit::Imm(m_pcFirst));
+					m_asm.cmp(r32(ss.get()), r32(temp.get()));
+					m_asm.jnz(exitToSS);
+					m_mem.mov(temp, getExecutedInstructionCount());
+					m_asm.cmp(r32(temp.get()), asmjit::Imm(g_maxLoopInstructions));
+					m_asm.jge(exitToSS);
+					m_mem.mov(temp, interruptPending());
+					m_asm.cmp(r32(temp.get()), asmjit::Imm(0));
+					m_asm.jnz(exitToSS);
+				}
+
+				if(aguLoopValid)
+					m_asm.jmp(loopBegin);
+
+				m_asm.bind(exitToSS);
 				setNextPC(ss);
 			}
 
-			dspRegPool().releaseAll();
 			m_asm.bind(end);
 		}
-#endif
+
 		if(m_possibleBranch)
 		{
 			const RegGP temp(*this);
@@ -201,20 +348,292 @@ namespace dsp56k
 		}
 		m_dspRegPool.releaseAll();
 
+		// Once the stack has been restored, the exit code emitted below may only use volatile registers
 		m_stack.popAll();
 
+		// A single bit test of a peripheral register that jumps to itself can only be left once the peripheral state has
+		// changed. It is not chained to itself but returns every time so that the Jit can skip emulated time instead
+		const bool idleLoop = !isFastInterrupt && !appendLoopCode && m_fragments.empty() && m_encodedInstructionCount == 1 &&
+			m_branchTarget == m_pcFirst && isPeripheralPoll(m_dsp, lastInstruction, m_singleOpWord);
+
+		if(!isFastInterrupt && (!appendLoopCode || nativeLoop) && !idleLoop && !(opFlags & (JitOps::WritePMem | JitOps::EnterLowPower)))
+			emitChainExits();
+
+		if(m_aguGuards)
+			emitAguGuards(cursorEntry);
+
+		m_ctx = nullptr;
+
 		if(empty())
 			return false;
 		if(opFlags & JitOps::WritePMem)
 			m_flags |= WritePMem;
-		if(appendLoopCode)
+		if(appendLoopCode && !nativeLoop)
 			m_flags |= LoopEnd;
+		if(idleLoop)
+			m_flags |= IdleLoop;
+		return true;
+	}
+
+	bool JitBlock::contains(const TWord _pc) const
+	{
+		if(_pc >= m_pcFirst && _pc < m_pcFirst + m_pMemSize)
+			return true;
+
+		for (const auto& f : m_fragments)
+		{
+			if(_pc >= f.first && _pc < f.first + f.size)
+				return true;
+		}
+		return false;
+	}
+
+	bool JitBlock::canFollow(const TWord _pc, const EmitContext& _ctx) const
+	{
+		// an op may read two words beyond its address if it is a REP, see getOpcode
+		if(!_ctx.pMem.empty() && (_pc < _ctx.pMemFirst || _pc + 2 >= _ctx.pMemFirst + _ctx.pMem.size()))
+			return false;
+
+		// do not duplicate code that we already have, this also prevents following endless loops
+		return _pc >= Vba_End && _pc < m_dsp.memory().size() && !contains(_pc) && _ctx.volatileP.find(_pc) == _ctx.volatileP.end();
+	}
+
+	void JitBlock::getOpcode(const TWord _pc, TWord& _wordA, TWord& _wordB) const
+	{
+		if(!m_ctx || m_ctx->pMem.empty())
+		{
+			m_dsp.memory().getOpcode(_pc, _wordA, _wordB);
+			return;
+		}
+
+		const auto& pMem = m_ctx->pMem;
+
+		// the copy covers the range up to pcMax plus the extension word of the last op and the op repeated by a REP
+		const auto get = [&](const TWord _i)
+		{
+			if(_i < m_ctx->pMemFirst || _i >= m_ctx->pMemFirst + pMem.size())
+			{
+				assert(false && "P memory read outside of the copy that the block is generated from");
+				return TWord(0);
+			}
+			return pMem[_i - m_ctx->pMemFirst];
+		};
+
+		_wordA = get(_pc);
+		_wordB = get(_pc + 1);
+	}
+
+	bool JitBlock::decode(const TWord _pc, const TWord _op, const OpcodeInfo*& _oi, const OpcodeInfo*& _oiAlu) const
+	{
+		_oi = nullptr;
+		_oiAlu = nullptr;
+
+		if(m_ctx)
+		{
+			const auto it = m_ctx->decodedOps.find(_pc);
+
+			if(it != m_ctx->decodedOps.end() && it->second.op == _op)
+			{
+				_oi = &g_opcodes[it->second.inst];
+				if(it->second.alu != InstructionCount)
+					_oiAlu = &g_opcodes[it->second.alu];
+				return true;
+			}
+		}
+
+		const auto& opcodes = m_dsp.opcodes();
+
+		if(Opcodes::isNonParallelOpcode(_op))
+		{
+			_oi = opcodes.findNonParallelOpcodeInfo(_op);
+			return _oi != nullptr;
+		}
+
+		_oi = opcodes.findParallelMoveOpcodeInfo(_op);
+
+		if(!_oi)
+			return false;
+
+		if(_op & 0xff)
+		{
+			_oiAlu = opcodes.findParallelAluOpcodeInfo(_op);
+			return _oiAlu != nullptr;
+		}
 		return true;
 	}
 
+	void JitBlock::addDecodedOp(const TWord _pc, const TWord _op, const OpcodeInfo& _oi, const OpcodeInfo* _oiAlu)
+	{
+		// an op that is repeated via REP is emitted more than once
+		if(!m_decodedOps.empty() && m_decodedOps.back().pc == _pc)
+			return;
+
+		m_decodedOps.push_back({_pc, _op, _oi.m_instruction, _oiAlu ? _oiAlu->m_instruction : InstructionCount});
+	}
+
+	CCRMask JitBlock::getDeadCCRBits(const JitOps& _ops, TWord _pc, const TWord _pcMax, const EmitContext& _ctx) const
+	{
+		// Returns the CCR bits that are written by the ops following _pc in this block before anyone reads them. Their
+		// computation is skipped for the op at _pc. Scanning stops at the first op that might read the CCR or might end
+		// the block, all bits that are still undecided at that point are live
+		CCRMask written;
+		TWord opSize;
+
+		if(g_maxInstructionsPerBlock > 0 || !_ops.getCCRWrites(written, opSize, _pc))
+			return static_cast<CCRMask>(0);
+
+		uint32_t undecided = CCR_C | CCR_Z | CCR_N | CCR_U | CCR_E;
+		uint32_t dead = 0;
+
+		for(uint32_t i=0; i<g_maxCCRLookahead && undecided; ++i)
+		{
+			if(_pc + opSize == _ctx.la + 1)
+				break;
+
+			_pc += opSize;
+
+			if(m_fragments.empty())
+			{
+				if(_pc >= _pcMax)
+					break;
+			}
+			else if(!canFollow(_pc, _ctx))
+			{
+				break;
+			}
+
+			if(!_ops.getCCRWrites(written, opSize, _pc))
+				break;
+
+			dead |= written & undecided;
+			undecided &= ~written;
+		}
+
+		return static_cast<CCRMask>(dead);
+	}
+
+	void JitBlock::addSize(const TWord _size)
+	{
+		if(m_fragments.empty())
+			m_pMemSize += _size;
+		else
+			m_fragments.back().size += _size;
+	}
+
 	void JitBlock::setNextPC(const JitRegGP& _pc)
 	{
 		mem().mov(nextPC(), _pc);
 		m_possibleBranch = true;
 	}
+
+	void JitBlock::useAguEntryValue(const TWord _agu)
+	{
+		if(m_aguEntryValid & (1u << _agu))
+			m_aguGuards |= 1u << _agu;
+	}
+
+	bool JitBlock::aguEntryValuesUnchanged() const
+	{
+		for(uint32_t i=0; i<m_aguEntryValues.size(); ++i)
+		{
+			if(!(m_aguGuards & (1u << i)))
+				continue;
+
+			TWord m;
+			if(!m_dspRegPool.getConstant(m, static_cast<JitDspRegPool::DspReg>(JitDspRegPool::DspM0 + i)) || m != m_aguEntryValues[i])
+				return false;
+		}
+		return true;
+	}
+
+	void JitBlock::emitAguGuards(asmjit::BaseNode* _entry)
+	{
+		// Verify the M registers that code has been generated for. If one differs, we return before anything has been
+		// executed and tell the Jit which block failed, it is generated again without these assumptions
+
+		const auto fail = m_asm.newLabel();
+
+		m_asm.ret();
+		m_asm.bind(fail);
+
+		const auto value = r32(g_funcArgGPs[2]);
+		const auto m = r32(g_funcArgGPs[3]);
+
+		m_asm.mov(m, asmjit::Imm(m_pcFirst));
+		m_asm.mov(mem().ptr(regReturnVal, &aguGuardFailed()), m);
+
+		// the final ret is appended by the Jit
+
+		auto* const cursorEnd = m_asm.cursor();
+		m_asm.setCursor(_entry);
+
+		for(uint32_t i=0; i<m_aguEntryValues.size(); ++i)
+		{
+			if(!(m_aguGuards & (1u << i)))
+				continue;
+
+			m_asm.move(m, mem().ptr(regReturnVal, reinterpret_cast<const uint32_t*>(&m_dsp.regs().m[i].var)));
+			m_asm.mov(value, asmjit::Imm(m_aguEntryValues[i]));
+			m_asm.cmp(m, value);
+			m_asm.jnz(fail);
+		}
+
+		m_asm.setCursor(cursorEnd);
+	}
+
+	void JitBlock::emitChainExits()
+	{
+		// Jump directly to the successor block if it has been linked by the Jit. The successor is entered with the
+		// same stack layout that we were called with, it returns to the dispatcher on our behalf
+
+		m_chainSlots[0].pc = m_pcLast;
+
+		if(m_branchTarget != g_pcInvalid && m_branchTarget != m_pcLast && m_branchTarget >= Vba_End)
+			m_chainSlots[1].pc = m_branchTarget;
+
+		const auto pc = r32(g_funcArgGPs[2]);
+		const auto func = g_funcArgGPs[3];
+
+		const auto end = m_asm.newLabel();
+
+		m_asm.move(r32(func), mem().ptr(regReturnVal, &getExecutedInstructionCount()));
+		m_asm.cmp(r32(func), asmjit::Imm(g_maxChainedInstructions));
+		m_asm.jge(end);
+
+		// return to the dispatcher if an interrupt is pending
+		m_asm.move(r32(func), mem().ptr(regReturnVal, &interruptPending()));
+		m_asm.cmp(r32(func), asmjit::Imm(0));
+		m_asm.jnz(end);
+
+		if(m_possibleBranch)
+			m_asm.move(pc, mem().ptr(regReturnVal, reinterpret_cast<const uint32_t*>(&m_dsp.regs().pc.var)));
+
+		for (const auto& slot : m_chainSlots)
+		{
+			if(slot.pc == g_pcInvalid)
+				continue;
+
+			const auto next = m_asm.newLabel();
+
+			if(m_possibleBranch)
+			{
+				m_asm.mov(r32(func), asmjit::Imm(slot.pc));
+				m_asm.cmp(pc, r32(func));
+				m_asm.jnz(next);
+			}
+
+			m_asm.move(func, mem().ptr(regReturnVal, reinterpret_cast<const uint64_t*>(&slot.func)));
+#ifdef HAVE_ARM64
+			m_asm.cbz(func, next);
+			m_asm.br(func);
+#else
+			m_asm.test(func, func);
+			m_asm.jz(next);
+			m_asm.jmp(func);
+#endif
+			m_asm.bind(next);
+		}
+
+		m_asm.bind(end);
+	}
 }
@@ -1,6 +1,6 @@
 #pragma once
 
-#include "jitcacheentry.h"
+#include "jitcache.h"
 #include "jitdspregs.h"
 #include "jitdspregpool.h"
 #include "jitmem.h"
@@ -8,8 +8,12 @@
 #include "jitregtypes.h"
 #include "jitruntimedata.h"
 #include "jitstackhelper.h"
+#include "opcodetypes.h"
 
+#include <array>
+#include <list>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <set>
 
@@ -18,6 +22,8 @@
 namespace dsp56k
 {
 	class DSP;
+	class JitOps;
+	struct OpcodeInfo;
 
 	class JitBlock final
 	{
@@ -29,10 +35,58 @@ namespace dsp56k
 			WritePMem			= 0x0002,
 			LoopEnd				= 0x0004,
 			InstructionLimit	= 0x0008,
+			IdleLoop			= 0x0010,	// polls a peripheral register and jumps to itself, see Jit::execFor
 		};
 
 		typedef void (*JitEntry)(Jit*, TWord, JitBlock*);
 
+		struct ChainSlot
+		{
+			TWord pc = g_pcInvalid;
+			JitEntry func = nullptr;
+			JitBlock* target = nullptr;
+		};
+
+		typedef std::array<ChainSlot, 2> ChainSlots;
+		typedef std::list<JitBlock*> LruList;
+
+		// An op as it has been decoded during code generation. For parallel ops, inst is the move and alu the ALU
+		// instruction, InstructionCount if there is none
+		struct DecodedOp
+		{
+			TWord pc;
+			TWord op;
+			Instruction inst;
+			Instruction alu;
+		};
+
+		// DSP state that code generation depends on, captured on the DSP thread when a block is requested
+		struct EmitContext
+		{
+			TWord la = 0;
+			TWord loopStart = g_pcInvalid;	// PC of the active DO loop body, g_pcInvalid if SR:LF is not set
+			std::set<TWord> volatileP;
+			bool pinDspRegs = false;		// DSP registers are kept in host registers across blocks, see Jit::setPinDspRegs
+			bool specializeAgu = false;		// generate AGU code for the M register values below, verified on block entry
+			std::array<TWord, 8> m{};
+			const uint8_t* codePages = nullptr;	// see JitCache::markCode
+
+			// If not empty, code is generated from this copy of P memory instead of P memory itself, which the DSP may
+			// write to while the block is compiled on the compile thread. Code outside of the copy is not followed
+			std::vector<TWord> pMem;
+			TWord pMemFirst = 0;
+
+			// ops that have been decoded in a previous run, keyed by PC, see Jit::loadCache. Used if the op word still matches
+			std::unordered_map<TWord, DecodedOp> decodedOps;
+		};
+
+		// P memory range that has been appended to a block by following an unconditional jump
+		struct Fragment
+		{
+			TWord first;
+			TWord size;
+		};
+
 		JitBlock(JitEmitter& _a, DSP& _dsp, JitRuntimeData& _runtimeData);
 
 		JitEmitter& asm_() { return m_asm; }
@@ -46,21 +100,48 @@ namespace dsp56k
 
 		operator JitEmitter& ()		{ return m_asm;	}
 
-		bool emit(TWord _pc, std::vector<JitCacheEntry>& _cache, const std::set<TWord>& _volatileP);
+		bool emit(TWord _pc, TWord _pcMax, const EmitContext& _ctx);
 		bool empty() const { return m_pMemSize == 0; }
 		TWord getPCFirst() const { return m_pcFirst; }
 		TWord getPMemSize() const { return m_pMemSize; }
-
-		void setFunc(const JitEntry _func) { m_func = _func; }
+		const std::vector<Fragment>& getFragments() const { return m_fragments; }
+		bool contains(TWord _pc) const;
+		bool hasPinnedDspRegs() const { return m_pinnedDspRegs; }
+		TWord getEmitLA() const { return m_emitLA; }
+		TWord getEmitLoopStart() const { return m_emitLoopStart; }
+		const uint8_t* getCodePages() const { return m_codePages; }
+
+		// reads an opcode from the P memory that the block is generated from, must only be called while emitting
+		void getOpcode(TWord _pc, TWord& _wordA, TWord& _wordB) const;
+
+		// Decodes the op word at _pc. For parallel ops, _oi is the move and _oiAlu the ALU op or nullptr if there is
+		// none. Must only be called while emitting
+		bool decode(TWord _pc, TWord _op, const OpcodeInfo*& _oi, const OpcodeInfo*& _oiAlu) const;
+		void addDecodedOp(TWord _pc, TWord _op, const OpcodeInfo& _oi, const OpcodeInfo* _oiAlu);
+		const std::vector<DecodedOp>& getDecodedOps() const { return m_decodedOps; }
+
+		void setFunc(const JitEntry _func, const size_t _codeSize) { m_func = _func; m_codeSize = _codeSize; }
 		const JitEntry& getFunc() const { return m_func; }
+		size_t getCodeSize() const { return m_codeSize; }
+
+		void setLastUsed(const uint64_t _epoch) { m_lastUsed = _epoch; }
+		uint64_t getLastUsed() const { return m_lastUsed; }
+
+		// position in the eviction list of the Jit and the epoch at which the block has been put there
+		void setLruPos(const LruList::iterator _pos, const uint64_t _epoch) { m_lruPos = _pos; m_lruEpoch = _epoch; }
+		void setLruEpoch(const uint64_t _epoch) { m_lruEpoch = _epoch; }
+		LruList::iterator getLruPos() const { return m_lruPos; }
+		uint64_t getLruEpoch() const { return m_lruEpoch; }
 
 		TWord& getEncodedInstructionCount() { return m_encodedInstructionCount; }
 
 		// JIT code writes these
 		TWord& getExecutedInstructionCount() const { return m_runtimeData.m_executedInstructionCount; }
 		TWord& nextPC() { return m_runtimeData.m_nextPC; }
-		uint32_t& pMemWriteAddress() { return m_runtimeData.m_pMemWriteAddress; }
-		uint32_t& pMemWriteValue() { return m_runtimeData.m_pMemWriteValue; }
+		const uint32_t& interruptPending() const { return reinterpret_cast<const uint32_t&>(m_runtimeData.m_interruptPending); }	// plain loads are relaxed atomic loads on all supported hosts
+		uint32_t& pMemWriteFirst() { return m_runtimeData.m_pMemWriteFirst; }
+		uint32_t& pMemWriteLast() { return m_runtimeData.m_pMemWriteLast; }
+		TWord& aguGuardFailed() { return m_runtimeData.m_aguGuardFailed; }
 		void setNextPC(const JitRegGP& _pc);
 
 		const std::string& getDisasm() const { return m_dspAsm; }
@@ -68,8 +149,27 @@ namespace dsp56k
 		TWord getSingleOpWord() const { return m_singleOpWord; }
 		uint32_t getFlags() const { return m_flags; }
 
+		void setBranchTarget(const TWord _pc) { m_branchTarget = _pc; }
+		ChainSlots& getChainSlots() { return m_chainSlots; }
+		std::set<JitBlock*>& getChainSources() { return m_chainSources; }
+
+		// Code that relies on the value an M register had at block entry registers it here to have it verified
+		void useAguEntryValue(TWord _agu);
+		void clearAguEntryValue(const TWord _agu) { m_aguEntryValid &= ~(1u << _agu); }
+
 	private:
+		void emitChainExits();
+		void emitAguGuards(asmjit::BaseNode* _entry);
+		bool aguEntryValuesUnchanged() const;
+		bool canFollow(TWord _pc, const EmitContext& _ctx) const;
+		void addSize(TWord _size);
+		CCRMask getDeadCCRBits(const JitOps& _ops, TWord _pc, TWord _pcMax, const EmitContext& _ctx) const;
+
 		JitEntry m_func = nullptr;
+		size_t m_codeSize = 0;
+		uint64_t m_lastUsed = 0;
+		LruList::iterator m_lruPos;
+		uint64_t m_lruEpoch = 0;
 		JitRuntimeData& m_runtimeData;
 
 		JitEmitter& m_asm;
@@ -84,12 +184,27 @@ namespace dsp56k
 		TWord m_pcFirst = 0;
 		TWord m_pcLast = 0;
 		TWord m_pMemSize = 0;
+		std::vector<Fragment> m_fragments;
+		std::vector<DecodedOp> m_decodedOps;
 		TWord m_lastOpSize = 0;
 		TWord m_singleOpWord = 0;
 		TWord m_encodedInstructionCount = 0;
+		TWord m_branchTarget = g_pcInvalid;
+
+		ChainSlots m_chainSlots;
+		std::set<JitBlock*> m_chainSources;
 
 		std::string m_dspAsm;
 		bool m_possibleBranch = false;
+		bool m_pinnedDspRegs = false;
+		TWord m_emitLA = 0;
+		TWord m_emitLoopStart = g_pcInvalid;
+		const uint8_t* m_codePages = nullptr;
+		const EmitContext* m_ctx = nullptr;
 		uint32_t m_flags = 0;
+
+		std::array<TWord, 8> m_aguEntryValues{};
+		uint32_t m_aguEntryValid = 0;	// M registers that have not been modified since block entry
+		uint32_t m_aguGuards = 0;		// M registers whose entry value generated code depends on
 	};
 }
@@ -0,0 +1,90 @@
+#include "jitcache.h"
+
+#include <algorithm>
+
+namespace dsp56k
+{
+	JitCache::JitCache(const size_t _size, const TJitUpdateFunc _defaultFunc)
+	: m_size(_size)
+	, m_defaultFunc(_defaultFunc)
+	{
+		m_pages.resize((_size + PageSize - 1) >> PageBits);
+
+		// covers the whole 24 bit address space, JIT code does not need to range check the address of a P write
+		m_codePages.resize(std::max<size_t>(_size, 0x1000000) >> CodePageBits, 0);
+		m_codePageOrder.resize(m_codePages.size(), 0);
+	}
+
+	TWord JitCache::findNextBlock(const TWord _pc) const
+	{
+		if(_pc >= m_size)
+			return static_cast<TWord>(m_size);
+
+		// blocks cover contiguous ranges, if there is none at _pc, the next one starts at the next entry PC
+		if(getBlock(_pc))
+			return _pc;
+
+		const auto it = m_blockStarts.lower_bound(_pc);
+
+		return it != m_blockStarts.end() ? *it : static_cast<TWord>(m_size);
+	}
+
+	void JitCache::markCode(const TWord _first, const TWord _count)
+	{
+		if(!_count)
+			return;
+
+		const auto last = (_first + _count - 1) >> CodePageBits;
+
+		for(auto p = _first >> CodePageBits; p <= last; ++p)
+		{
+			if(m_codePages[p])
+				continue;
+
+			m_codePages[p] = 1;
+			m_codePageOrder[p] = m_codePageCount++;
+		}
+	}
+
+	bool JitCache::isCode(const TWord _first, const TWord _count, const uint32_t _codePageCount) const
+	{
+		if(!_count)
+			return false;
+
+		const auto last = (_first + _count - 1) >> CodePageBits;
+
+		for(auto p = _first >> CodePageBits; p <= last; ++p)
+		{
+			if(!m_codePages[p] || m_codePageOrder[p] >= _codePageCount)
+				return false;
+		}
+		return true;
+	}
+
+	JitBlock* JitCache::popSingleOp(const TWord _pc, const TWord _op)
+	{
+		const auto it = m_singleOpCache.find(singleOpKey(_pc, _op));
+
+		if(it == m_singleOpCache.end())
+			return nullptr;
+
+		auto* block = it->second;
+		m_singleOpCache.erase(it);
+		return block;
+	}
+
+	bool JitCache::pushSingleOp(const TWord _pc, const TWord _op, JitBlock* _block)
+	{
+		return m_singleOpCache.insert(std::make_pair(singleOpKey(_pc, _op), _block)).second;
+	}
+
+	void JitCache::allocPage(std::unique_ptr<JitCacheEntry[]>& _page)
+	{
+		_page.reset(new JitCacheEntry[PageSize]);
+
+		for(TWord i=0; i<PageSize; ++i)
+			_page[i] = JitCacheEntry{m_defaultFunc, nullptr};
+
+		++m_allocatedPageCount;
+	}
+}
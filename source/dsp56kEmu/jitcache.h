@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "jitcacheentry.h"
+
+namespace dsp56k
+{
+	// Two-level table of JIT cache entries. Pages are allocated on first access only, P memory that never holds
+	// any code does not cost anything but a null page pointer
+	class JitCache
+	{
+	public:
+		static constexpr TWord PageBits = 10;
+		static constexpr TWord PageSize = 1 << PageBits;
+		static constexpr TWord PageMask = PageSize - 1;
+
+		static constexpr TWord CodePageBits = 8;
+		static constexpr TWord CodePageSize = 1 << CodePageBits;
+
+		JitCache(size_t _size, TJitUpdateFunc _defaultFunc);
+
+		JitCacheEntry& operator[](const TWord _pc)
+		{
+			auto& page = m_pages[_pc >> PageBits];
+			if(!page)
+				allocPage(page);
+			return page[_pc & PageMask];
+		}
+
+		JitBlock* getBlock(const TWord _pc) const
+		{
+			const auto& page = m_pages[_pc >> PageBits];
+			return page ? page[_pc & PageMask].block : nullptr;
+		}
+
+		// returns the PC of the first block at or after _pc, or the cache size if there is none
+		TWord findNextBlock(TWord _pc) const;
+
+		// entry PCs of all blocks in the cache, needs to be maintained by the Jit whenever it adds or removes a block
+		void addBlockStart(const TWord _pc) { m_blockStarts.insert(_pc); }
+		void removeBlockStart(const TWord _pc) { m_blockStarts.erase(_pc); }
+
+		size_t size() const { return m_size; }
+		size_t getPageCount() const { return m_pages.size(); }
+		bool isPageAllocated(const size_t _page) const { return m_pages[_page] != nullptr; }
+		size_t getAllocatedPageCount() const { return m_allocatedPageCount; }
+
+		// One byte per P page, non-zero if the page contains code that has been compiled or interpreted. Pages are never
+		// unmarked. JIT code uses the map to skip P writes that cannot hit any code
+		void markCode(TWord _first, TWord _count);
+		bool isCode(const TWord _pc) const { return m_codePages[_pc >> CodePageBits] != 0; }
+		bool isCode(TWord _first, TWord _count, uint32_t _codePageCount) const;	// true if all pages of the range were marked when getCodePageCount() returned _codePageCount
+		const uint8_t* getCodePages() const { return m_codePages.data(); }
+		uint32_t getCodePageCount() const { return m_codePageCount; }
+
+		// cache for 1-word-ops that have been removed from the cache, keyed by PC and op word
+		JitBlock* popSingleOp(TWord _pc, TWord _op);
+		bool pushSingleOp(TWord _pc, TWord _op, JitBlock* _block);
+		std::unordered_map<uint64_t, JitBlock*>& getSingleOpCache() { return m_singleOpCache; }
+
+	private:
+		void allocPage(std::unique_ptr<JitCacheEntry[]>& _page);
+
+		static uint64_t singleOpKey(const TWord _pc, const TWord _op)
+		{
+			return (static_cast<uint64_t>(_pc) << 32) | _op;
+		}
+
+		const size_t m_size;
+		const TJitUpdateFunc m_defaultFunc;
+		std::vector<std::unique_ptr<JitCacheEntry[]>> m_pages;
+		size_t m_allocatedPageCount = 0;
+		std::set<TWord> m_blockStarts;
+
+		std::vector<uint8_t> m_codePages;
+		std::vector<uint32_t> m_codePageOrder;	// page => value of m_codePageCount before it has been marked
+		uint32_t m_codePageCount = 0;
+
+		std::unordered_map<uint64_t, JitBlock*> m_singleOpCache;
+	};
+}
@@ -1,7 +1,5 @@
 #pragma once
 
-#include <map>
-
 #include "types.h"
 
 namespace dsp56k
@@ -15,6 +13,5 @@ namespace dsp56k
 	{
 		TJitUpdateFunc func;
 		JitBlock* block;
-		std::map<TWord,JitBlock*> singleOpCache;
 	};
 }
@@ -4,6 +4,8 @@
 #include "jitblock.h"
 #include "jitemitter.h"
 
+#include <algorithm>
+
 #define LOGRP(S)		{}
 //#define LOGRP(S)		LOG(S)
 
@@ -12,6 +14,16 @@ namespace dsp56k
 	static constexpr uint32_t g_gpCount = sizeof(g_dspPoolGps) / sizeof(g_dspPoolGps[0]);
 	static constexpr uint32_t g_xmmCount = sizeof(g_dspPoolXmms) / sizeof(g_dspPoolXmms[0]);
 
+	static bool poolShiftReg()
+	{
+#if defined(HAVE_X86_64) && !defined(_MSC_VER)
+		// with BMI2, shift counts can be in any register, see ShiftReg. On Windows, rcx is the first function argument
+		return JitEmitter::hasBMI2();
+#else
+		return false;
+#endif
+	}
+
 	constexpr const char* g_dspRegNames[] = 
 	{
 		"r0",	"r1",	"r2",	"r3",	"r4",	"r5",	"r6",	"r7",
@@ -33,6 +45,11 @@ namespace dsp56k
 
 	static_assert((sizeof(g_dspRegNames) / sizeof(g_dspRegNames[0])) == JitDspRegPool::DspCount);
 
+	// DSP registers in the order in which they are assigned to the pinned host registers
+	constexpr JitDspRegPool::DspReg g_pinnedDspRegs[] = { JitDspRegPool::DspSR, JitDspRegPool::DspX, JitDspRegPool::DspY };
+
+	static constexpr uint32_t g_pinnedCount = std::min(sizeof(g_dspPinnedGps) / sizeof(g_dspPinnedGps[0]), sizeof(g_pinnedDspRegs) / sizeof(g_pinnedDspRegs[0]));
+
 	JitDspRegPool::JitDspRegPool(JitBlock& _block) : m_block(_block), m_lockedGps(0), m_writtenDspRegs(0)
 	{
 		clear();
@@ -54,6 +71,13 @@ namespace dsp56k
 
 	JitRegGP JitDspRegPool::get(DspReg _reg, bool _read, bool _write)
 	{
+		if(_write)
+			clearConstant(_reg);
+
+		JitRegGP pinned;
+		if(getPinned(pinned, _reg))
+			return pinned;
+
 		if(_write)
 		{
 			setWritten(_reg);
@@ -171,7 +195,7 @@ namespace dsp56k
 		assert(m_xmList.empty());
 		assert(m_writtenDspRegs == 0);
 		assert(m_lockedGps == 0);
-		assert(m_gpList.available() == g_gpCount);
+		assert(m_gpList.available() == g_gpCount + (poolShiftReg() ? 1 : 0));
 		assert(m_xmList.available() == g_xmmCount);
 
 		// We use this to restore ordering of GPs and XMMs as they need to be predictable in native loops
@@ -206,6 +230,9 @@ namespace dsp56k
 
 	bool JitDspRegPool::isInUse(DspReg _reg) const
 	{
+		JitRegGP pinned;
+		if(getPinned(pinned, _reg))
+			return true;
 		return m_gpList.isUsed(_reg) || m_xmList.isUsed(_reg);
 	}
 
@@ -228,7 +255,7 @@ namespace dsp56k
 		JitRegGP gpSrc;
 		JitReg128 xmSrc;
 
-		if(m_gpList.get(gpSrc, _src))
+		if(m_gpList.get(gpSrc, _src) || getPinned(gpSrc, _src))
 			m_block.asm_().mov(_dst, gpSrc);
 		else if(m_xmList.get(xmSrc, _src))
 			m_block.asm_().movq(_dst, xmSrc);
@@ -237,6 +264,26 @@ namespace dsp56k
 		return true;
 	}
 
+	void JitDspRegPool::setConstant(const DspReg _reg, const TWord _value)
+	{
+		assert(_reg < DspA);
+
+		if(m_repMode)
+			return;
+
+		m_constantValues[_reg] = _value;
+		m_constants |= 1u<<static_cast<uint32_t>(_reg);
+	}
+
+	bool JitDspRegPool::getConstant(TWord& _value, const DspReg _reg) const
+	{
+		// in rep mode, an op is emitted once but executed multiple times
+		if(m_repMode || _reg >= DspA || !(m_constants & (1u<<static_cast<uint32_t>(_reg))))
+			return false;
+		_value = m_constantValues[_reg];
+		return true;
+	}
+
 	void JitDspRegPool::setIsParallelOp(bool _isParallelOp)
 	{
 		m_isParallelOp = _isParallelOp;
@@ -244,6 +291,8 @@ namespace dsp56k
 
 	bool JitDspRegPool::move(DspReg _dst, DspReg _src)
 	{
+		clearConstant(_dst);
+
 		JitRegGP gpSrc;
 		JitReg128 xmSrc;
 
@@ -308,6 +357,83 @@ namespace dsp56k
 		release(_aluWriteReg);
 	}
 
+	bool JitDspRegPool::getPinned(JitRegGP& _dst, const DspReg _reg) const
+	{
+		if(!m_block.hasPinnedDspRegs())
+			return false;
+
+		for(uint32_t i=0; i<g_pinnedCount; ++i)
+		{
+			if(g_pinnedDspRegs[i] == _reg)
+			{
+				_dst = g_dspPinnedGps[i];
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool JitDspRegPool::isPinnedHostReg(const JitRegGP& _gp)
+	{
+		for(uint32_t i=0; i<g_pinnedCount; ++i)
+		{
+			if(g_dspPinnedGps[i].equals(r64(_gp)))
+				return true;
+		}
+		return false;
+	}
+
+	void JitDspRegPool::loadPinned(JitEmitter& _asm, DSP& _dsp, const JitRegGP& _scratch)
+	{
+		_asm.mov(r64(_scratch), asmjit::Imm(reinterpret_cast<uint64_t>(&_dsp.regs())));
+
+		for(uint32_t i=0; i<g_pinnedCount; ++i)
+		{
+			JitRegGP gp;
+			const auto ptr = makePinnedPtr(_dsp, _scratch, i, gp);
+			_asm.move(gp, ptr);
+		}
+	}
+
+	void JitDspRegPool::storePinned(JitEmitter& _asm, DSP& _dsp, const JitRegGP& _scratch)
+	{
+		_asm.mov(r64(_scratch), asmjit::Imm(reinterpret_cast<uint64_t>(&_dsp.regs())));
+
+		for(uint32_t i=0; i<g_pinnedCount; ++i)
+		{
+			JitRegGP gp;
+			const auto ptr = makePinnedPtr(_dsp, _scratch, i, gp);
+			_asm.mov(ptr, gp);
+		}
+	}
+
+	JitMemPtr JitDspRegPool::makePinnedPtr(DSP& _dsp, const JitRegGP& _base, const uint32_t _index, JitRegGP& _hostReg)
+	{
+		const auto& r = _dsp.regs();
+
+		const void* ptr = nullptr;
+		size_t size = 0;
+
+		switch (g_pinnedDspRegs[_index])
+		{
+		case DspSR:	ptr = &r.sr.var;	size = sizeof(r.sr.var);	break;
+		case DspX:	ptr = &r.x.var;		size = sizeof(r.x.var);		break;
+		case DspY:	ptr = &r.y.var;		size = sizeof(r.y.var);		break;
+		default:
+			assert(false && "DSP register cannot be pinned");
+			break;
+		}
+
+		if(size == sizeof(uint32_t))
+			_hostReg = r32(g_dspPinnedGps[_index]);
+		else
+			_hostReg = r64(g_dspPinnedGps[_index]);
+
+		const auto offset = static_cast<const uint8_t*>(ptr) - reinterpret_cast<const uint8_t*>(&r);
+
+		return Jitmem::makePtr(r64(_base), static_cast<uint32_t>(offset), static_cast<uint32_t>(size));
+	}
+
 	void JitDspRegPool::makeSpace(const DspReg _wantedReg)
 	{
 		if(m_xmList.isFull())
@@ -369,6 +495,11 @@ namespace dsp56k
 		for(size_t i=0; i<g_gpCount; ++i)
 			m_gpList.addHostReg(g_dspPoolGps[i]);
 
+#ifdef HAVE_X86_64
+		if(poolShiftReg())
+			m_gpList.addHostReg(regShiftCount);
+#endif
+
 		for(size_t i=0; i<g_xmmCount; ++i)
 			m_xmList.addHostReg(g_dspPoolXmms[i]);
 
@@ -9,7 +9,9 @@
 
 namespace dsp56k
 {
+	class DSP;
 	class JitBlock;
+	class JitEmitter;
 
 	class JitDspRegPool
 	{
@@ -52,6 +54,12 @@ namespace dsp56k
 		bool hasWrittenRegs() const { return m_writtenDspRegs != 0; }
 
 		void setRepMode(bool _repMode) { m_repMode = _repMode; }
+
+		// AGU registers that have been set to an immediate value in this block, their value is known at compile time
+		void setConstant(DspReg _reg, TWord _value);
+		bool getConstant(TWord& _value, DspReg _reg) const;
+		void clearConstant(DspReg _reg)		{ if(_reg < DspA) m_constants &= ~(1u<<static_cast<uint32_t>(_reg)); }
+		void clearConstants()				{ m_constants = 0; }
 		bool isInUse(const JitReg128& _xmm) const;
 		bool isInUse(const JitRegGP& _gp) const;
 		bool isInUse(DspReg _reg) const;
@@ -80,7 +88,15 @@ namespace dsp56k
 
 		void parallelOpEpilog();
 
+		// DSP registers that stay in host registers across blocks if the block uses pinned registers
+		bool getPinned(JitRegGP& _dst, DspReg _reg) const;
+		static bool isPinnedHostReg(const JitRegGP& _gp);
+		static void loadPinned(JitEmitter& _asm, DSP& _dsp, const JitRegGP& _scratch);
+		static void storePinned(JitEmitter& _asm, DSP& _dsp, const JitRegGP& _scratch);
+
 	private:
+		static JitMemPtr makePinnedPtr(DSP& _dsp, const JitRegGP& _base, uint32_t _index, JitRegGP& _hostReg);
+
 		void parallelOpEpilog(DspReg _aluReadReg, DspReg _aluWriteReg);
 		
 		void makeSpace(DspReg _wantedReg);
@@ -257,5 +273,8 @@ namespace dsp56k
 		bool m_isParallelOp = false;
 		bool m_repMode = false;
 		JitMemPtr m_dspPtr;
+
+		uint32_t m_constants = 0;
+		TWord m_constantValues[DspA];
 	};
 }
@@ -1,8 +1,13 @@
 #include "jitemitter.h"
 
+#include "dspassert.h"
 #include "jithelper.h"
 #include "jitregtypes.h"
 
+#ifndef HAVE_ARM64
+#include "asmjit/core/cpuinfo.h"
+#endif
+
 namespace dsp56k
 {
 #ifdef HAVE_ARM64
@@ -191,6 +196,66 @@ namespace dsp56k
 	{
 		tst(_src, asmjit::Imm(1ull << _bitIndex));
 	}
+#else
+	static JitRegGP shiftCount(const JitRegGP& _dst, const JitRegGP& _shift)
+	{
+		// the count operand of shlx/shrx/sarx has the size of the destination, without BMI2 it needs to be cl
+		if(!JitEmitter::hasBMI2())
+		{
+			assert(r64(_shift).equals(regShiftCount) && "shift count needs to be in the shift register");
+			return asmjit::x86::cl;
+		}
+		if(_dst.isGpq())
+			return r64(_shift);
+		return r32(_shift);
+	}
+
+	void JitEmitter::shl(const JitRegGP& _dst, const JitRegGP& _shift)
+	{
+		if(hasBMI2())
+			shlx(_dst, _dst, shiftCount(_dst, _shift));
+		else
+			JitBuilder::shl(_dst, shiftCount(_dst, _shift));
+	}
+
+	void JitEmitter::shr(const JitRegGP& _dst, const JitRegGP& _shift)
+	{
+		if(hasBMI2())
+			shrx(_dst, _dst, shiftCount(_dst, _shift));
+		else
+			JitBuilder::shr(_dst, shiftCount(_dst, _shift));
+	}
+
+	void JitEmitter::sal(const JitRegGP& _dst, const JitRegGP& _shift)
+	{
+		shl(_dst, _shift);
+	}
+
+	void JitEmitter::sar(const JitRegGP& _dst, const JitRegGP& _shift)
+	{
+		if(hasBMI2())
+			sarx(_dst, _dst, shiftCount(_dst, _shift));
+		else
+			JitBuilder::sar(_dst, shiftCount(_dst, _shift));
+	}
+
+	bool JitEmitter::hasBMI1()
+	{
+		static const bool has = asmjit::CpuInfo::host().hasFeature(asmjit::CpuFeatures::X86::kBMI);
+		return has;
+	}
+
+	bool JitEmitter::hasBMI2()
+	{
+		static const bool has = asmjit::CpuInfo::host().hasFeature(asmjit::CpuFeatures::X86::kBMI2);
+		return has;
+	}
+
+	bool JitEmitter::hasLZCNT()
+	{
+		static const bool has = asmjit::CpuInfo::host().hasFeature(asmjit::CpuFeatures::X86::kLZCNT);
+		return has;
+	}
 #endif
 
 	void JitEmitter::move(const JitRegGP& _dst, const JitMemPtr& _src)
@@ -80,7 +80,23 @@ namespace dsp56k
 		void sub(const JitRegGP& _dst, const JitRegGP& _src);
 
 		void bitTest(const JitRegGP& _src, TWord _bitIndex);
+#else
+		using JitBuilder::shl;
+		using JitBuilder::shr;
+		using JitBuilder::sal;
+		using JitBuilder::sar;
+
+		// Shifts by a register. With BMI2, shlx/shrx/sarx are used which accept any register and leave the flags
+		// untouched. Without, the shift count has to be in the shift register, see ShiftReg
+		void shl(const JitRegGP& _dst, const JitRegGP& _shift);
+		void shr(const JitRegGP& _dst, const JitRegGP& _shift);
+		void sal(const JitRegGP& _dst, const JitRegGP& _shift);
+		void sar(const JitRegGP& _dst, const JitRegGP& _shift);
 
+		// optional instruction set extensions of the host CPU, detected once at runtime
+		static bool hasBMI1();
+		static bool hasBMI2();
+		static bool hasLZCNT();
 #endif
 
 		void move(const JitRegGP& _dst, const JitMemPtr& _src);
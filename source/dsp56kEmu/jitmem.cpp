@@ -265,6 +265,29 @@ namespace dsp56k
 
 	void Jitmem::readPeriph(const JitReg64& _dst, EMemArea _area, const TWord& _offset) const
 	{
+		auto* periph = m_block.dsp().getPeriph(_area == MemArea_Y ? 1 : 0);
+		const auto access = periph->getDirectReadAccess(_offset);
+
+		if(access.isConstant)
+		{
+			m_block.asm_().mov(r32(_dst), asmjit::Imm(access.value));
+			return;
+		}
+
+		if(access.ptr)
+		{
+			mov(_dst, *access.ptr);
+			return;
+		}
+
+		if(access.read)
+		{
+			m_block.asm_().mov(g_funcArgGPs[0], asmjit::Imm(reinterpret_cast<uint64_t>(periph)));
+			m_block.stack().call(asmjit::func_as_ptr(access.read));
+			m_block.asm_().mov(r32(_dst), r32(regReturnVal));
+			return;
+		}
+
 		FuncArg r1(m_block, 1);
 		FuncArg r2(m_block, 2);
 
@@ -307,6 +330,29 @@ namespace dsp56k
 
 	void Jitmem::writePeriph(EMemArea _area, const TWord& _offset, const JitReg64& _value) const
 	{
+		auto* periph = m_block.dsp().getPeriph(_area == MemArea_Y ? 1 : 0);
+		const auto access = periph->getDirectWriteAccess(_offset);
+
+		if(access.isConstant)
+			return;
+
+		if(access.ptr)
+		{
+			const RegGP temp(m_block);
+			m_block.asm_().mov(ptr(r64(temp.get()), access.ptr), r32(_value));
+			return;
+		}
+
+		if(access.write)
+		{
+			FuncArg r1(m_block, 1);
+
+			m_block.asm_().mov(r32(g_funcArgGPs[1]), r32(_value));
+			m_block.asm_().mov(g_funcArgGPs[0], asmjit::Imm(reinterpret_cast<uint64_t>(periph)));
+			m_block.stack().call(asmjit::func_as_ptr(access.write));
+			return;
+		}
+
 		FuncArg r1(m_block, 1);
 		FuncArg r2(m_block, 2);
 		FuncArg r3(m_block, 3);
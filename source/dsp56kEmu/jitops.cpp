@@ -284,11 +284,36 @@ namespace dsp56k
 	{
 	}
 
+	static bool isInterpreted(const Instruction _inst)
+	{
+		// instructions without JIT implementation that are executed by calling the interpreter. Only instructions that
+		// the interpreter implements are listed, loops and instructions that change the program flow are not part of
+		// this list, the block would not know how to continue
+		switch (_inst)
+		{
+		case Eor_SD:		case Eor_xx:		case Eor_xxxx:
+		case Or_xx:			case Or_xxxx:
+		case Ror:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	static TWord getOpSize(const OpcodeInfo& _oi, const TWord _op)
+	{
+		if(_oi.m_extensionWordType == None)
+			return 1;
+		if(hasField(_oi, Field_MMM))
+			return getFieldValue(_oi.m_instruction, Field_MMM, _op) == 6 ? 2 : 1;
+		return 2;
+	}
+
 	void JitOps::emit(const TWord _pc)
 	{
 		TWord op;
 		TWord opB;
-		m_block.dsp().memory().getOpcode(_pc, op, opB);
+		m_block.getOpcode(_pc, op, opB);
 		emit(_pc, op, opB);
 	}
 
@@ -305,36 +330,39 @@ namespace dsp56k
 			return;
 		}
 
-		if(Opcodes::isNonParallelOpcode(_op))
+		const OpcodeInfo* oi;
+		const OpcodeInfo* oiAlu;
+
+		if(!m_block.decode(_pc, _op, oi, oiAlu))
 		{
-			const auto* oi = m_opcodes.findNonParallelOpcodeInfo(_op);
+			m_block.decode(_pc, _op, oi, oiAlu);		// retry here to help debugging
+			assert(0 && "illegal instruction");
+		}
+
+		m_block.addDecodedOp(_pc, _op, *oi, oiAlu);
 
-			if(!oi)
+		if(Opcodes::isNonParallelOpcode(_op))
+		{
+			if(isInterpreted(oi->m_instruction) && m_repMode == RepNone)
 			{
-				m_opcodes.findNonParallelOpcodeInfo(_op);		// retry here to help debugging
-				assert(0 && "illegal instruction");
+				m_instruction = oi->m_instruction;
+				emitInterpreted(*oi, _op);
+				return;
 			}
 
 			emit(oi->m_instruction, _op);
 			return;
 		}
 
-		const auto* oiMove = m_opcodes.findParallelMoveOpcodeInfo(_op);
-		if(!oiMove)
-		{
-			m_opcodes.findParallelMoveOpcodeInfo(_op);		// retry here to help debugging
-			assert(0 && "illegal instruction");
-		}
-
-		const OpcodeInfo* oiAlu = nullptr;
+		const auto* oiMove = oi;
 
-		if(_op & 0xff)
+		if(oiAlu)
 		{
-			oiAlu = m_opcodes.findParallelAluOpcodeInfo(_op);
-			if(!oiAlu)
+			if(isInterpreted(oiAlu->m_instruction) && m_repMode == RepNone)
 			{
-				m_opcodes.findParallelAluOpcodeInfo(_op);	// retry here to help debugging
-				assert(0 && "invalid instruction");						
+				m_instruction = Parallel;
+				emitInterpreted(*oiMove, _op);
+				return;
 			}
 		}
 
@@ -424,6 +452,22 @@ namespace dsp56k
 		assert(0 && "instruction not implemented");
 	}
 
+	void callDSPInterpretOp(DSP* const _dsp, const TWord _pc)
+	{
+		_dsp->getJit().interpretOp(_pc);
+	}
+
+	void JitOps::emitInterpreted(const OpcodeInfo& _oi, const TWord _op)
+	{
+		m_opSize = getOpSize(_oi, _op);
+
+		// the interpreter works on the DSP registers in memory, they are loaded again when needed
+		updateDirtyCCR();
+		m_block.dspRegPool().releaseAll();
+
+		callDSPFunc(&callDSPInterpretOp, m_pcCurrentOp);
+	}
+
 	inline void JitOps::do_exec(RegGP& _lc, TWord _addr)
 	{
 		If(m_block, [&](auto _toFalse)
@@ -635,9 +679,7 @@ namespace dsp56k
 		const RegGP n(m_block);
 		m_asm.mov(n, asmjit::Imm(aSigned));
 
-		const AguRegM m(m_block, rrr, true);
-
-		updateAddressRegister(r32(r.get()), r32(n.get()), r32(m.get()));
+		updateAddressRegister(r32(r.get()), r32(n.get()), rrr);
 
 		if( dddd < 8 )									// r0-r7
 		{
@@ -707,6 +749,8 @@ namespace dsp56k
 
 	inline void JitOps::jmp(TWord _absAddr)
 	{
+		m_block.setBranchTarget(_absAddr);
+
 		const RegGP r(m_block);
 		m_asm.mov(r, asmjit::Imm(_absAddr));
 		jmp(r32(r.get()));
@@ -714,11 +758,130 @@ namespace dsp56k
 
 	inline void JitOps::jsr(const TWord _absAddr)
 	{
+		m_block.setBranchTarget(_absAddr);
+
 		const RegGP r(m_block);
 		m_asm.mov(r32(r.get()), asmjit::Imm(_absAddr));
 		jsr(r32(r.get()));
 	}
 
+	bool JitOps::getConstantJumpTarget(TWord& _target, TWord& _opSize, const TWord _pc) const
+	{
+		TWord op;
+		TWord opB;
+		m_block.getOpcode(_pc, op, opB);
+
+		if(!op || !Opcodes::isNonParallelOpcode(op))
+			return false;
+
+		const OpcodeInfo* oi;
+		const OpcodeInfo* oiAlu;
+
+		if(!m_block.decode(_pc, op, oi, oiAlu))
+			return false;
+
+		switch (oi->m_instruction)
+		{
+		case Jmp_xxx:
+			_target = getFieldValue<Jmp_xxx, Field_aaaaaaaaaaaa>(op);
+			_opSize = 1;
+			return true;
+		case Bra_xxx:
+			_target = _pc + getRelativeAddressOffset<Bra_xxx>(op);
+			_opSize = 1;
+			return true;
+		case Bra_xxxx:
+			_target = _pc + signextend<int,24>(opB);
+			_opSize = 2;
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	static bool getOpCCRWrites(CCRMask& _written, TWord& _opSize, const OpcodeInfo& _oi, const TWord _op)
+	{
+		// only ops that are known to never read the CCR are listed here, the written bits need to be the ones that the
+		// JIT code writes unconditionally, which is not necessarily what the manual says
+		_opSize = getOpSize(_oi, _op);
+
+		switch (_oi.m_instruction)
+		{
+		case Nop:
+		case Move_Nop:	case Move_xx:	case Mover:		case Move_ea:
+		case Movex_ea:	case Movex_aa:	case Movexr_ea:	case Movexr_A:
+		case Movey_ea:	case Movey_aa:	case Moveyr_ea:	case Moveyr_A:
+		case Movel_ea:	case Movel_aa:	case Movexy:
+		case Lua_ea:	case Lua_Rn:
+		case Tfr:
+			_written = static_cast<CCRMask>(0);
+			return true;
+		case Add_SD:	case Add_xx:	case Add_xxxx:
+		case Sub_SD:	case Sub_xx:	case Sub_xxxx:
+		case Addl:		case Addr:
+		case Asl_D:		case Asl_ii:	case Asl_S1S2D:
+		case Asr_D:		case Asr_ii:	case Asr_S1S2D:
+		case Cmp_S1S2:	case Cmp_xxS2:	case Cmp_xxxxS2:	case Cmpm_S1S2:
+		case Inc:		case Dec:
+			_written = static_cast<CCRMask>(CCR_C | CCR_E | CCR_N | CCR_U | CCR_Z);
+			return true;
+		case Abs:	case Clr:	case Neg:	case Tst:	case Rnd:
+		case Mac_S1S2:	case Mac_S:		case Macr_S1S2:	case Macr_S:	case Macsu:
+		case Mpy_S1S2D:	case Mpy_SD:	case Mpyr_S1S2D:	case Mpyr_SD:	case Mpy_su:	case Mpyi:
+		case Dmac:
+			_written = static_cast<CCRMask>(CCR_E | CCR_N | CCR_U | CCR_Z);
+			return true;
+		case And_SD:	case And_xx:	case And_xxxx:
+		case Or_SD:		case Or_xx:		case Or_xxxx:
+		case Not:
+			_written = static_cast<CCRMask>(CCR_N | CCR_Z);
+			return true;
+		case Lsl_D:		case Lsl_ii:
+		case Lsr_D:		case Lsr_ii:
+			_written = static_cast<CCRMask>(CCR_C | CCR_N | CCR_Z);
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	bool JitOps::getCCRWrites(CCRMask& _written, TWord& _opSize, const TWord _pc) const
+	{
+		TWord op;
+		TWord opB;
+		m_block.getOpcode(_pc, op, opB);
+
+		if(!op)
+		{
+			_written = static_cast<CCRMask>(0);
+			_opSize = 1;
+			return true;
+		}
+
+		const OpcodeInfo* oi;
+		const OpcodeInfo* oiAlu;
+
+		if(!m_block.decode(_pc, op, oi, oiAlu))
+			return false;
+
+		if(Opcodes::isNonParallelOpcode(op))
+			return getOpCCRWrites(_written, _opSize, *oi, op);
+
+		// IFcc is not listed as its ALU op is executed conditionally
+		if(!getOpCCRWrites(_written, _opSize, *oi, op))
+			return false;
+
+		TWord aluSize;
+		return !oiAlu || getOpCCRWrites(_written, aluSize, *oiAlu, op);
+	}
+
+	void JitOps::setDeadCCRBits(const CCRMask _bits)
+	{
+		// lazily evaluated bits that are dead are never needed
+		m_ccrDead = _bits;
+		ccr_clearDirty(_bits);
+	}
+
 	inline void JitOps::op_Rti(TWord op)
 	{
 		popPCSR();
@@ -742,12 +905,14 @@ namespace dsp56k
 
 		TWord opA;
 		TWord opB;
-		m_block.dsp().mem.getOpcode(m_pcCurrentOp + 1, opA, opB);
+		m_block.getOpcode(m_pcCurrentOp + 1, opA, opB);
+
+		const OpcodeInfo* oi;
+		const OpcodeInfo* oiAlu;
 
-		if(!OpcodeInfo::isParallelOpcode(opA))
+		if(!OpcodeInfo::isParallelOpcode(opA) && m_block.decode(m_pcCurrentOp + 1, opA, oi, oiAlu))
 		{
-			const auto* oi = m_block.dsp().opcodes().findNonParallelOpcodeInfo(opA);
-			if(oi && oi->getInstruction() == Div)
+			if(oi->getInstruction() == Div)
 			{
 				op_Rep_Div(opA, _lc);
 				m_opSize++;
@@ -881,4 +1046,26 @@ namespace dsp56k
 	{
 		callDSPFunc(&callDSPReset, op);
 	}
+
+	void callDSPStop(DSP* const _dsp, const TWord op)
+	{
+		_dsp->op_Stop(op);
+	}
+
+	void callDSPWait(DSP* const _dsp, const TWord op)
+	{
+		_dsp->op_Wait(op);
+	}
+
+	inline void JitOps::op_Stop(TWord op)
+	{
+		callDSPFunc(&callDSPStop, op);
+		m_resultFlags |= EnterLowPower;
+	}
+
+	inline void JitOps::op_Wait(TWord op)
+	{
+		callDSPFunc(&callDSPWait, op);
+		m_resultFlags |= EnterLowPower;
+	}
 }
@@ -26,7 +26,8 @@ namespace dsp56k
 
 			WritePMem			= 0x01,
 			WriteToLC			= 0x02,
-			WriteToLA			= 0x04
+			WriteToLA			= 0x04,
+			EnterLowPower		= 0x08		// WAIT or STOP, the block needs to return to the Jit
 		};
 
 		JitOps(JitBlock& _block, bool _fastInterrupt = false);
@@ -109,13 +110,13 @@ namespace dsp56k
 		void op_Btst_pp(TWord op);
 		void op_Btst_qq(TWord op);
 		void op_Btst_D(TWord op);
-		void op_Clb(TWord op)				{ errNotImplemented(op); }
+		void op_Clb(TWord op);
 		void op_Clr(TWord op);
 		void op_Cmp_S1S2(TWord op);
 		void op_Cmp_xxS2(TWord op);
 		void op_Cmp_xxxxS2(TWord op);
 		void op_Cmpm_S1S2(TWord op);
-		void op_Cmpu_S1S2(TWord op)			{ errNotImplemented(op); }
+		void op_Cmpu_S1S2(TWord op);
 		void op_Debug(TWord op);
 		void op_Debugcc(TWord op);
 		void op_Dec(TWord op);
@@ -231,8 +232,8 @@ namespace dsp56k
 		void op_Mpyri(TWord op)					{ errNotImplemented(op); }
 		void op_Neg(TWord op);
 		void op_Nop(TWord op);
-		void op_Norm(TWord op)					{ errNotImplemented(op); }
-		void op_Normf(TWord op)					{ errNotImplemented(op); }
+		void op_Norm(TWord op);
+		void op_Normf(TWord op);
 		void op_Not(TWord op);
 		void op_Or_SD(TWord op);
 		void op_Or_xx(TWord op)					{ errNotImplemented(op); }
@@ -256,7 +257,7 @@ namespace dsp56k
 		void op_Rti(TWord op);
 		void op_Rts(TWord op);
 		void op_Sbc(TWord op)					{ errNotImplemented(op); }
-		void op_Stop(TWord op)					{ errNotImplemented(op); }
+		void op_Stop(TWord op);
 		void op_Sub_SD(TWord op);
 		void op_Sub_xx(TWord op);
 		void op_Sub_xxxx(TWord op);
@@ -270,7 +271,7 @@ namespace dsp56k
 		void op_Trapcc(TWord op)				{ errNotImplemented(op); }
 		void op_Tst(TWord op);
 		void op_Vsl(TWord op)					{ errNotImplemented(op); }
-		void op_Wait(TWord op)					{ errNotImplemented(op); }
+		void op_Wait(TWord op);
 
 		// helpers
 		void signextend56to64(const JitReg64& _reg) const;
@@ -282,10 +283,17 @@ namespace dsp56k
 
 		void updateAddressRegister(const JitReg64& _r, TWord _mmm, TWord _rrr, bool _writeR = true, bool _returnPostR = false);
 		void updateAddressRegister(const JitReg32& _r, const JitReg32& _n, const JitReg32& _m);
+		void updateAddressRegister(const JitReg32& _r, const JitReg32& _n, TWord _rrr);
 		void updateAddressRegisterConst(const JitReg32& _r, const int _n, const JitReg32& _m);
+		void updateAddressRegisterConst(const JitReg32& _r, int _n, TWord _rrr);
 		void updateAddressRegisterModulo(const JitReg32& _r, const JitReg32& _n, const JitReg32& _m) const;
 		void updateAddressRegisterMultipleWrapModulo(const JitReg32& _r, const JitReg32& _n, const JitReg32& _m);
-		static void updateAddressRegisterBitreverse(const JitReg32& _r, const JitReg32& _n, const JitReg32& _m);
+		void updateAddressRegisterMultipleWrapModulo(const JitReg32& _r, int _n, const JitReg32& _m);
+		void updateAddressRegisterBitreverse(const JitReg32& _r, const JitReg32& _n);
+		void bitreverse24(const JitReg32& _r) const;
+		void calcModuloMask(const JitReg32& _dst, const JitReg32& _m, const JitReg64& _temp);
+
+		void recordPMemWrite(const JitReg32& _ea, const JitReg64& _tempA, const JitReg64& _tempB);
 
 		void signed24To56(const JitReg64& _r) const;
 
@@ -340,6 +348,9 @@ namespace dsp56k
 
 		template <Instruction Inst, typename std::enable_if<hasFields<Inst, Field_MMM, Field_RRR>()>::type* = nullptr> EffectiveAddressType effectiveAddress(const JitReg64& _dst, TWord _op);
 		template <Instruction Inst, typename std::enable_if<hasFields<Inst, Field_MMM, Field_RRR>()>::type* = nullptr> EffectiveAddressType effectiveAddressType(TWord _op) const;
+		template <Instruction Inst, typename std::enable_if<hasFields<Inst, Field_MMM, Field_RRR>()>::type* = nullptr> bool effectiveAddressConstant(TWord& _addr, TWord _op);
+		void setConstantAgu(TWord _dddddd, TWord _value) const;
+		bool getConstantM(TWord& _m, TWord _rrr) const;
 
 		template <Instruction Inst, typename std::enable_if<!hasField<Inst,Field_s>() && hasFields<Inst, Field_MMM, Field_RRR, Field_S>()>::type* = nullptr> void readMem(const JitReg64& _dst, TWord _op);
 		template <Instruction Inst, typename std::enable_if<hasFields<Inst, Field_MMM, Field_RRR>()>::type* = nullptr> EffectiveAddressType readMem(const JitReg64& _dst, TWord _op, EMemArea _area);
@@ -440,6 +451,7 @@ namespace dsp56k
 		void ccr_set(CCRMask _mask);
 		void ccr_dirty(TWord _aluIndex, const JitReg64& _alu, CCRMask _dirtyBits = static_cast<CCRMask>(CCR_E | CCR_U));
 		void ccr_clearDirty(CCRMask _mask);
+		bool ccr_isDead(const CCRBit _bit) const { return (m_ccrDead & (1 << _bit)) != 0; }
 		void updateDirtyCCR();
 		void updateDirtyCCR(CCRMask _whatToUpdate);
 		void updateDirtyCCR(const JitReg64& _alu, CCRMask _dirtyBits);
@@ -552,6 +564,15 @@ namespace dsp56k
 		void jmp(TWord _absAddr);
 		void jsr(TWord _absAddr);
 
+		// returns true if the op at _pc is an unconditional jump to a constant address that has no other side effects
+		bool getConstantJumpTarget(TWord& _target, TWord& _opSize, TWord _pc) const;
+
+		// returns false if the op at _pc might read CCR bits. Otherwise, _written receives the CCR bits that are always written by it
+		bool getCCRWrites(CCRMask& _written, TWord& _opSize, TWord _pc) const;
+
+		// CCR bits that are overwritten by a following op before being read, their computation is skipped for the next op
+		void setDeadCCRBits(CCRMask _bits);
+
 		TWord getOpSize() const { return m_opSize; }
 		Instruction getInstruction() const { return m_instruction; }
 
@@ -569,6 +590,7 @@ namespace dsp56k
 		};
 
 		void errNotImplemented(TWord op);
+		void emitInterpreted(const OpcodeInfo& _oi, TWord _op);
 
 		JitBlock& m_block;
 		const Opcodes& m_opcodes;
@@ -576,6 +598,7 @@ namespace dsp56k
 		JitEmitter& m_asm;
 
 		CCRMask& m_ccrDirty;
+		CCRMask m_ccrDead = static_cast<CCRMask>(0);
 		bool m_ccr_update_clear = true;
 
 		TWord m_pcCurrentOp = 0;
@@ -561,6 +561,58 @@ namespace dsp56k
 	inline void JitOps::op_Bset_qq(TWord op)	{ bitmod_ppqq<Bset_qq>(op, &JitOps::alu_bset); }
 	inline void JitOps::op_Bset_D(TWord op)		{ bitmod_D<Bset_D>(op, &JitOps::alu_bset); }
 
+	inline void JitOps::op_Clb(TWord op)
+	{
+		const auto S = getFieldValue<Clb, Field_S>(op);
+		const auto D = getFieldValue<Clb, Field_D>(op);
+
+		// D1 = 9 - number of leading zeros (S positive) or ones (S negative), D = 0 if S is zero
+		const RegGP s(m_block);
+		m_dspRegs.getALU(s, S);
+
+		const RegGP count(m_block);
+
+#ifdef HAVE_ARM64
+		m_asm.lsl(s, s, asmjit::Imm(8));
+		m_asm.asr(count, s.get(), asmjit::Imm(63));
+		m_asm.eor(s, s, count.get());
+		m_asm.clz(count, s.get());
+#else
+		m_asm.shl(s, asmjit::Imm(8));
+		m_asm.mov(count, s.get());
+		m_asm.sar(count, asmjit::Imm(63));
+		m_asm.xor_(s, count.get());
+
+		if(JitEmitter::hasLZCNT())
+		{
+			m_asm.lzcnt(count, s.get());
+		}
+		else
+		{
+			m_asm.bsr(count, s.get());
+			m_asm.xor_(count, asmjit::Imm(63));
+		}
+#endif
+
+		AluRef d(m_block, D, false, true);
+		m_asm.mov(d, asmjit::Imm(9));
+		m_asm.sub(d, count.get());
+
+#ifdef HAVE_ARM64
+		m_asm.cmp(s, asmjit::Imm(0));
+		m_asm.csel(d, s.get(), d, asmjit::arm::CondCode::kZero);
+#else
+		m_asm.test(s, s.get());
+		m_asm.cmovz(d, s.get());
+#endif
+
+		m_asm.shl(d, asmjit::Imm(24));
+		m_dspRegs.mask56(d);
+
+		ccr_clear(CCR_V);
+		ccr_dirty(D, d, static_cast<CCRMask>(CCR_N | CCR_Z));
+	}
+
 	inline void JitOps::op_Clr(TWord op)
 	{
 		const auto D = getFieldValue<Clr, Field_d>(op);
@@ -623,6 +675,41 @@ namespace dsp56k
 		alu_cmp(D, r, true);
 	}
 
+	inline void JitOps::op_Cmpu_S1S2(TWord op)
+	{
+		const auto D = getFieldValue<Cmpu_S1S2, Field_d>(op);
+		const auto ggg = getFieldValue<Cmpu_S1S2, Field_ggg>(op);
+
+		const RegGP s(m_block);
+
+		switch (ggg)
+		{
+		case 0:	m_dspRegs.getALU(s, D ? 0 : 1);	break;
+		case 4:	XY0to56(s, 0);	break;
+		case 5:	XY0to56(s, 1);	break;
+		case 6:	XY1to56(s, 0);	break;
+		case 7:	XY1to56(s, 1);	break;
+		default:
+			assert(0 && "invalid ggg value");
+		}
+
+		// unsigned compare of bits 47-0, move them to the top to make use of the host carry flag. Only C and Z are affected
+		AluReg d(m_block, D, true);
+		m_asm.shl(d, asmjit::Imm(16));
+		m_asm.shl(s, asmjit::Imm(16));
+
+#ifdef HAVE_ARM64
+		m_asm.subs(d, d, s.get());
+		ccr_update_ifNotCarry(CCRB_C);
+#else
+		m_asm.sub(d, s.get());
+		ccr_update_ifCarry(CCRB_C);
+#endif
+
+		m_asm.cmp(d, asmjit::Imm(0));
+		ccr_update_ifZero(CCRB_Z);
+	}
+
 	inline void JitOps::op_Dec(TWord op)
 	{
 		const auto ab = getFieldValue<Dec,Field_d>(op);
@@ -710,39 +797,47 @@ namespace dsp56k
 		const RegGP widthOffset(m_block);
 		decode_sss_read(widthOffset, sss);
 
-		const ShiftReg width(m_block);
-		m_asm.mov(width, widthOffset.get());
-		m_asm.shr(width, asmjit::Imm(12));
-		m_asm.and_(width, asmjit::Imm(0x3f));
-
-		RegGP offset(m_block);
-		m_asm.mov(offset, widthOffset.get());
-		m_asm.and_(offset, asmjit::Imm(0x3f));
-
-		m_asm.neg(width);
-		m_asm.add(width, asmjit::Imm(56));
-
-		const auto& mask = widthOffset;
-		m_asm.mov(mask, asmjit::Imm(g_alu_max_56_u));
-		m_asm.shr(mask, width.get());
-
 		AluReg s(m_block, abSrc, abSrc != abDst);
+
 #ifdef HAVE_X86_64
-		if(asmjit::CpuInfo::host().hasFeature(asmjit::CpuFeatures::X86::kBMI2))
+		if(JitEmitter::hasBMI2())
 		{
-			m_asm.shrx(s, s, offset.get());	
+			// s = bzhi(s >> offset, width)
+			const RegGP width(m_block);
+			m_asm.mov(width, widthOffset.get());
+			m_asm.shr(width, asmjit::Imm(12));
+			m_asm.and_(width, asmjit::Imm(0x3f));
+
+			const auto& offset = widthOffset;
+			m_asm.and_(offset, asmjit::Imm(0x3f));
+
+			m_asm.shrx(s, s, offset.get());
+			m_asm.bzhi(s, s, width.get());
 		}
 		else
 #endif
 		{
-			const ShiftReg shift(m_block);
-			m_asm.mov(shift, offset.get());
-			m_asm.shr(s, shift.get());
-		}
+			const ShiftReg width(m_block);
+			m_asm.mov(width, widthOffset.get());
+			m_asm.shr(width, asmjit::Imm(12));
+			m_asm.and_(width, asmjit::Imm(0x3f));
 
-		m_asm.and_(s, mask.get());
+			const RegGP offset(m_block);
+			m_asm.mov(offset, widthOffset.get());
+			m_asm.and_(offset, asmjit::Imm(0x3f));
 
-		offset.release();
+			m_asm.neg(width);
+			m_asm.add(width, asmjit::Imm(56));
+
+			const auto& mask = widthOffset;
+			m_asm.mov(mask, asmjit::Imm(g_alu_max_56_u));
+			m_asm.shr(mask, width.get());
+
+			m_asm.mov(width, offset.get());
+			m_asm.shr(s, width.get());
+
+			m_asm.and_(s, mask.get());
+		}
 
 		JitReg64 aluD;
 		
@@ -909,6 +1004,88 @@ namespace dsp56k
 	{
 	}
 
+	inline void JitOps::op_Norm(TWord op)
+	{
+		const auto rrr = getFieldValue<Norm, Field_RRR>(op);
+		const auto D = getFieldValue<Norm, Field_d>(op);
+
+		// one normalization step: ASL D and Rn-1 if E=0, U=1 and Z=0, ASR D and Rn+1 if E=1, nothing otherwise
+		RegGP ccr(m_block);
+		getCCR(ccr);
+		m_asm.and_(ccr, asmjit::Imm(CCR_E | CCR_U | CCR_Z));
+
+		const ShiftReg shift(m_block);
+		m_asm.mov(shift, asmjit::Imm(1));
+
+		const auto updateR = [&](const bool _inc)
+		{
+			const RegGP r(m_block);
+			m_dspRegs.getR(r, rrr);
+			if(_inc)
+				m_asm.inc(r);
+			else
+				m_asm.dec(r);
+			m_asm.and_(r, asmjit::Imm(0xffffff));
+			m_dspRegs.setR(rrr, r);
+		};
+
+		If(m_block, [&](auto _toFalse)
+		{
+			m_asm.cmp(r32(ccr.get()), asmjit::Imm(CCR_U));
+			m_asm.jnz(_toFalse);
+		}, [&]()
+		{
+			alu_asl(D, D, shift);
+			updateR(false);
+		}, [&]()
+		{
+			If(m_block, [&](auto _toFalse)
+			{
+#ifdef HAVE_ARM64
+				m_asm.bitTest(ccr, CCRB_E);
+				m_asm.jz(_toFalse);
+#else
+				m_asm.bt(ccr, asmjit::Imm(CCRB_E));
+				m_asm.jnc(_toFalse);
+#endif
+			}, [&]()
+			{
+				alu_asr(D, D, shift);
+				updateR(true);
+			});
+		});
+	}
+
+	inline void JitOps::op_Normf(TWord op)
+	{
+		const auto sss = getFieldValue<Normf, Field_sss>(op);
+		const auto D = getFieldValue<Normf, Field_D>(op);
+
+		// ASR D by S if S is positive, ASL D by -S otherwise
+		const ShiftReg shift(m_block);
+		decode_sss_read(shift.get(), sss);
+
+		If(m_block, [&](auto _toFalse)
+		{
+#ifdef HAVE_ARM64
+			m_asm.bitTest(shift, 23);
+			m_asm.jz(_toFalse);
+#else
+			m_asm.bt(shift, asmjit::Imm(23));
+			m_asm.jnc(_toFalse);
+#endif
+		}, [&]()
+		{
+			m_asm.neg(shift);
+			m_asm.and_(shift, asmjit::Imm(0x3f));
+			alu_asl(D, D, shift);
+		}, [&]()
+		{
+			m_asm.and_(shift, asmjit::Imm(0x3f));
+			alu_asr(D, D, shift);
+		});
+	}
+
 	inline void JitOps::op_Or_SD(TWord op)
 	{
 		const auto D = getFieldValue<Or_SD, Field_d>(op);
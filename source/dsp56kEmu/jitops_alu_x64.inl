@@ -66,9 +66,25 @@ namespace dsp56k
 
 		m_asm.sal(alu, asmjit::Imm(8));				// we want to hit the 64 bit boundary to make use of the native carry flag so pre-shift by 8 bit (56 => 64)
 
-		m_asm.sal(alu, _v.get());					// now do the real shift
+		if(JitEmitter::hasBMI2())
+		{
+			// shlx does not modify the flags. The carry is the last bit shifted out, which is bit 64-n. A shift by zero tests bit 0, which is always zero
+			{
+				const RegGP bit(m_block);
+				m_asm.mov(bit, _v.get());
+				m_asm.neg(bit);
+				m_asm.bt(alu, bit.get());
+			}
+			ccr_update_ifCarry(CCRB_C);
 
-		ccr_update_ifCarry(CCRB_C);					// copy the host carry flag to the DSP carry flag
+			m_asm.sal(alu, _v.get());
+		}
+		else
+		{
+			m_asm.sal(alu, _v.get());				// now do the real shift
+
+			ccr_update_ifCarry(CCRB_C);				// copy the host carry flag to the DSP carry flag
+		}
 
 		// Overflow: Set if Bit 55 is changed any time during the shift operation, cleared otherwise.
 		// The easiest way to check this is to shift back and compare if the initial alu value is identical ot the backshifted one
@@ -11,18 +11,27 @@ namespace dsp56k
 	inline void JitOps::ccr_clear(CCRMask _mask)
 	{
 		// TODO: by using BIC, we should be able to encode any kind of SR bits, this version fails on ARMv8 with "invalid immediate" if we specify more than one bit. But BIC with "Gp, Gp, Imm" is not available (yet?)
-		m_asm.and_(m_dspRegs.getSR(JitDspRegs::ReadWrite), asmjit::Imm(~_mask));
+		const auto mask = _mask & ~m_ccrDead;
+		if(mask)
+			m_asm.and_(m_dspRegs.getSR(JitDspRegs::ReadWrite), asmjit::Imm(~mask));
 		ccr_clearDirty(_mask);
 	}
 
 	inline void JitOps::ccr_set(CCRMask _mask)
 	{
-		m_asm.or_(m_dspRegs.getSR(JitDspRegs::ReadWrite), asmjit::Imm(_mask));
+		const auto mask = _mask & ~m_ccrDead;
+		if(mask)
+			m_asm.or_(m_dspRegs.getSR(JitDspRegs::ReadWrite), asmjit::Imm(mask));
 		ccr_clearDirty(_mask);
 	}
 
 	inline void JitOps::ccr_dirty(TWord _aluIndex, const JitReg64& _alu, CCRMask _dirtyBits)
 	{
+		_dirtyBits = static_cast<CCRMask>(_dirtyBits & ~m_ccrDead);
+
+		if(!_dirtyBits)
+			return;
+
 		if(g_useSRCache)
 		{
 			// if the last dirty call marked bits as dirty that are no longer to be dirtied now, we need to update them
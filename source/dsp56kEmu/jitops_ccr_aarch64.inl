@@ -65,6 +65,9 @@ namespace dsp56k
 
 	void JitOps::ccr_update(CCRBit _bit, asmjit::arm::CondCode _armConditionCode)
 	{
+		if(ccr_isDead(_bit))
+			return;
+
 		const RegGP ra(m_block);
 		m_asm.cset(ra, _armConditionCode);
 		ccr_update(ra, _bit);
@@ -78,6 +81,9 @@ namespace dsp56k
 
 		ccr_clearDirty(mask);
 
+		if(ccr_isDead(_bit))
+			return;
+
 		if(isSticky)
 		{
 			const auto sr = m_dspRegs.getSR(JitDspRegs::ReadWrite);
@@ -22,6 +22,9 @@ namespace dsp56k
 
 	inline void JitOps::ccr_update_ifZero(CCRBit _bit)
 	{
+		if(ccr_isDead(_bit))
+			return;
+
 		const RegGP ra(m_block);
 		m_asm.setz(ra);										// set reg to 1 if last operation returned zero, 0 otherwise
 		ccr_update(ra, _bit);
@@ -29,6 +32,9 @@ namespace dsp56k
 
 	inline void JitOps::ccr_update_ifNotZero(CCRBit _bit)
 	{
+		if(ccr_isDead(_bit))
+			return;
+
 		const RegGP ra(m_block);
 		m_asm.setnz(ra);									// set reg to 1 if last operation returned != 0, 0 otherwise
 		ccr_update(ra, _bit);
@@ -36,6 +42,9 @@ namespace dsp56k
 
 	inline void JitOps::ccr_update_ifGreater(CCRBit _bit)
 	{
+		if(ccr_isDead(_bit))
+			return;
+
 		const RegGP ra(m_block);
 		m_asm.setg(ra);										// set reg to 1 if last operation returned >, 0 otherwise
 		ccr_update(ra, _bit);
@@ -43,6 +52,9 @@ namespace dsp56k
 
 	inline void JitOps::ccr_update_ifGreaterEqual(CCRBit _bit)
 	{
+		if(ccr_isDead(_bit))
+			return;
+
 		const RegGP ra(m_block);
 		m_asm.setge(ra);									// set reg to 1 if last operation returned >=, 0 otherwise
 		ccr_update(ra, _bit);
@@ -50,6 +62,9 @@ namespace dsp56k
 
 	inline void JitOps::ccr_update_ifLess(CCRBit _bit)
 	{
+		if(ccr_isDead(_bit))
+			return;
+
 		const RegGP ra(m_block);
 		m_asm.setl(ra);										// set reg to 1 if last operation returned <, 0 otherwise
 		ccr_update(ra, _bit);
@@ -57,6 +72,9 @@ namespace dsp56k
 
 	inline void JitOps::ccr_update_ifLessEqual(CCRBit _bit)
 	{
+		if(ccr_isDead(_bit))
+			return;
+
 		const RegGP ra(m_block);
 		m_asm.setle(ra);									// set reg to 1 if last operation returned <=, 0 otherwise
 		ccr_update(ra, _bit);
@@ -64,6 +82,9 @@ namespace dsp56k
 
 	inline void JitOps::ccr_update_ifCarry(CCRBit _bit)
 	{
+		if(ccr_isDead(_bit))
+			return;
+
 		const RegGP ra(m_block);
 		m_asm.setc(ra);										// set reg to 1 if last operation generated carry, 0 otherwise
 		ccr_update(ra, _bit);
@@ -71,6 +92,9 @@ namespace dsp56k
 
 	inline void JitOps::ccr_update_ifNotCarry(CCRBit _bit)
 	{
+		if(ccr_isDead(_bit))
+			return;
+
 		const RegGP ra(m_block);
 		m_asm.setnc(ra);									// set reg to 1 if last operation did NOT generate carry, 0 otherwise
 		ccr_update(ra, _bit);
@@ -78,6 +102,9 @@ namespace dsp56k
 
 	inline void JitOps::ccr_update_ifParity(CCRBit _bit)
 	{
+		if(ccr_isDead(_bit))
+			return;
+
 		const RegGP ra(m_block);
 		m_asm.setp(ra);										// set reg to 1 if number of 1 bits is even, 0 otherwise
 		ccr_update(ra, _bit);
@@ -85,6 +112,9 @@ namespace dsp56k
 
 	inline void JitOps::ccr_update_ifNotParity(CCRBit _bit)
 	{
+		if(ccr_isDead(_bit))
+			return;
+
 		const RegGP ra(m_block);
 		m_asm.setnp(ra);									// set reg to 1 if number of 1 bits is odd, 0 otherwise
 		ccr_update(ra, _bit);
@@ -92,6 +122,9 @@ namespace dsp56k
 
 	inline void JitOps::ccr_update_ifAbove(CCRBit _bit)
 	{
+		if(ccr_isDead(_bit))
+			return;
+
 		const RegGP ra(m_block);
 		m_asm.seta(ra);
 		ccr_update(ra, _bit);
@@ -99,6 +132,9 @@ namespace dsp56k
 
 	inline void JitOps::ccr_update_ifBelow(CCRBit _bit)
 	{
+		if(ccr_isDead(_bit))
+			return;
+
 		const RegGP ra(m_block);
 		m_asm.setb(ra);
 		ccr_update(ra, _bit);
@@ -108,6 +144,12 @@ namespace dsp56k
 	{
 		const auto mask = static_cast<CCRMask>(1 << _bit);
 
+		if(ccr_isDead(_bit))
+		{
+			ccr_clearDirty(mask);
+			return;
+		}
+
 		if (m_ccr_update_clear && _bit != CCRB_L && _bit != CCRB_S)
 			ccr_clear(mask);												// clear out old status register value
 		else
@@ -141,7 +183,7 @@ namespace dsp56k
 			const RegGP r(m_block);
 			m_asm.mov(r, _alu);
 			m_asm.shr(r, asmjit::Imm(32));	// thx to intel, we are only allowed to shift 32 at max. Therefore, we need to split it
-			m_asm.shr(r, shift.get().r8());
+			m_asm.shr(r, shift.get());
 			m_asm.and_(r, asmjit::Imm(0x3));
 		}
 		ccr_update_ifParity(CCRB_U);
@@ -182,9 +224,9 @@ namespace dsp56k
 				const ShiftReg s0s1(m_block);
 
 				sr_getBitValue(s0s1, SRB_S0);
-				m_asm.shl(mask, s0s1.get().r8());
+				m_asm.shl(mask, s0s1.get());
 				sr_getBitValue(s0s1, SRB_S1);
-				m_asm.shr(mask, s0s1.get().r8());
+				m_asm.shr(mask, s0s1.get());
 			}
 
 			m_asm.and_(mask, asmjit::Imm(0x3ff));
@@ -58,12 +58,10 @@ namespace dsp56k
 			return;
 		}
 
-		const AguRegM m(m_block, _rrr, true);
-
 		if(_mmm == 7)													/* 111 -(Rn)   */
 		{
 			m_dspRegs.getR(_r, _rrr);
-			updateAddressRegisterConst(r32(_r),-1, r32(m.get()));
+			updateAddressRegisterConst(r32(_r),-1, _rrr);
 			if(_writeR)
 				m_block.regs().setR(_rrr, _r);
 			return;
@@ -77,7 +75,7 @@ namespace dsp56k
 			m_dspRegs.getN(n, _rrr);
 			signextend24To32(r32(n.get()));
 			m_asm.mov(_r, r.get());
-			updateAddressRegister(r32(_r), r32(n.get()), r32(m.get()));
+			updateAddressRegister(r32(_r), r32(n.get()), _rrr);
 			return;
 		}
 
@@ -103,22 +101,22 @@ namespace dsp56k
 			const RegGP n(m_block);
 			m_dspRegs.getN(n, _rrr);
 			m_asm.neg(n);
-			updateAddressRegister(r32_, r32(n.get()), r32(m.get()));
+			updateAddressRegister(r32_, r32(n.get()), _rrr);
 		}	
 		if(_mmm == 1)													/* 001 (Rn)+Nn */
 		{
 			const RegGP n(m_block);
 			m_dspRegs.getN(n, _rrr);
 			signextend24To32(r32(n.get()));
-			updateAddressRegister(r32_, r32(n.get()), r32(m.get()));
+			updateAddressRegister(r32_, r32(n.get()), _rrr);
 		}
 		if(_mmm == 2)													/* 010 (Rn)-   */
 		{
-			updateAddressRegisterConst(r32_,-1, r32(m.get()));
+			updateAddressRegisterConst(r32_,-1, _rrr);
 		}
 		if(_mmm == 3)													/* 011 (Rn)+   */
 		{
-			updateAddressRegisterConst(r32_,1, r32(m.get()));
+			updateAddressRegisterConst(r32_,1, _rrr);
 		}
 
 		if(_writeR)
@@ -130,6 +128,87 @@ namespace dsp56k
 		}
 	}
 
+	inline void JitOps::updateAddressRegister(const JitReg32& _r, const JitReg32& _n, const TWord _rrr)
+	{
+		TWord m;
+
+		if(getConstantM(m, _rrr) && m == 0xffffff)
+		{
+			m_block.useAguEntryValue(_rrr);
+			m_asm.add(_r, _n);
+			m_asm.and_(_r, asmjit::Imm(0xffffff));
+			return;
+		}
+
+		const AguRegM mReg(m_block, _rrr, true);
+		updateAddressRegister(_r, _n, r32(mReg.get()));
+	}
+
+	inline void JitOps::updateAddressRegisterConst(const JitReg32& _r, const int _n, const TWord _rrr)
+	{
+		TWord m;
+
+		// bit reverse and multiple-wrap modulo are left to the generic code
+		if(!getConstantM(m, _rrr) || (m != 0xffffff && (m == 0 || m > 0x7fff)))
+		{
+			const AguRegM mReg(m_block, _rrr, true);
+			updateAddressRegisterConst(_r, _n, r32(mReg.get()));
+			return;
+		}
+
+		m_block.useAguEntryValue(_rrr);
+
+		if(m == 0xffffff)
+		{
+			if(_n == 1)
+				m_asm.inc(_r);
+			else
+				m_asm.dec(_r);
+			m_asm.and_(_r, asmjit::Imm(0xffffff));
+			return;
+		}
+
+		// modulo with a known M, the modulo mask does not need to be computed at runtime
+
+		TWord moduloMask = m;
+		moduloMask |= moduloMask >> 1;
+		moduloMask |= moduloMask >> 2;
+		moduloMask |= moduloMask >> 4;
+		moduloMask |= moduloMask >> 8;
+
+		const RegGP p64(m_block);
+		const auto p = r32(p64.get());
+		const auto temp = r32(regReturnVal);
+
+		m_asm.mov(p, _r);
+		m_asm.and_(p, asmjit::Imm(moduloMask));
+
+		if(_n == -1)
+		{
+			// r += ((p-1) >> 31) & modulo
+			m_asm.dec(_r);
+			m_asm.dec(p);
+			m_asm.sar(p, asmjit::Imm(31));
+			m_asm.mov(temp, asmjit::Imm(m + 1));
+			m_asm.and_(p, temp);
+			m_asm.add(_r, p);
+		}
+		else	// _n==1
+		{
+			// r -= ((m - (p+1)) >> 31) & modulo
+			m_asm.inc(_r);
+			m_asm.inc(p);
+			m_asm.mov(temp, asmjit::Imm(m));
+			m_asm.sub(temp, p);
+			m_asm.sar(temp, asmjit::Imm(31));
+			m_asm.mov(p, asmjit::Imm(m + 1));
+			m_asm.and_(temp, p);
+			m_asm.sub(_r, temp);
+		}
+
+		m_asm.and_(_r, asmjit::Imm(0xffffff));
+	}
+
 	inline void JitOps::updateAddressRegisterModulo(const JitReg32& r, const JitReg32& n, const JitReg32& m) const
 	{
 /*
@@ -150,10 +229,7 @@ namespace dsp56k
 			*/
 
 			const ShiftReg shifter(m_block);
-			m_asm.bsr(shifter, m);								// returns index of MSB that is 1
-			m_asm.mov(moduloMask, asmjit::Imm(2));
-			m_asm.shl(moduloMask, shifter.get());
-			m_asm.dec(moduloMask);
+			calcModuloMask(r32(moduloMask), m, shifter);
 
 			/*
 			rOffset = r & moduloMask
@@ -191,10 +267,73 @@ namespace dsp56k
 
 	inline void JitOps::updateAddressRegisterMultipleWrapModulo(const JitReg32& _r, const JitReg32& _n,	const JitReg32& _m)
 	{
+		/*
+		The modulo is a power of two given by the lower 15 bits of M. Only the bits below it are modified, an offset
+		exceeding the modulo wraps around as often as needed:
+		r = (r & ~moduloMask) | ((r + n) & moduloMask)
+		The lower 15 bits are never zero here, M=$8000 is handled as bit reverse like the interpreter does
+		*/
+
+		const auto moduloMask = regReturnVal;
+		const ShiftReg shifter(m_block);
+		const auto p = r32(shifter.get());
+
+		m_asm.mov(r32(moduloMask), _m);
+		m_asm.and_(r32(moduloMask), asmjit::Imm(0x7fff));
+		calcModuloMask(r32(moduloMask), r32(moduloMask), shifter);
+
+#ifdef HAVE_X86_64
+		if(JitEmitter::hasBMI1())
+		{
+			m_asm.andn(p, r32(moduloMask), _r);
+			m_asm.add(_r, _n);
+			m_asm.and_(_r, r32(moduloMask));
+			m_asm.or_(_r, p);
+			return;
+		}
+#endif
+
+		m_asm.mov(p, _r);
+		m_asm.and_(p, r32(moduloMask));
+		m_asm.sub(_r, p);
+		m_asm.add(p, _n);
+		m_asm.and_(p, r32(moduloMask));
+		m_asm.add(_r, p);
 	}
 
-	inline void JitOps::updateAddressRegisterBitreverse(const JitReg32& _r, const JitReg32& _n, const JitReg32& _m)
+	inline void JitOps::updateAddressRegisterMultipleWrapModulo(const JitReg32& _r, const int _n, const JitReg32& _m)
 	{
+		const auto moduloMask = regReturnVal;
+		const ShiftReg shifter(m_block);
+		const auto p = r32(shifter.get());
+
+		m_asm.mov(r32(moduloMask), _m);
+		m_asm.and_(r32(moduloMask), asmjit::Imm(0x7fff));
+		calcModuloMask(r32(moduloMask), r32(moduloMask), shifter);
+
+#ifdef HAVE_X86_64
+		if(JitEmitter::hasBMI1())
+		{
+			m_asm.andn(p, r32(moduloMask), _r);
+			if(_n == 1)
+				m_asm.inc(_r);
+			else
+				m_asm.dec(_r);
+			m_asm.and_(_r, r32(moduloMask));
+			m_asm.or_(_r, p);
+			return;
+		}
+#endif
+
+		m_asm.mov(p, _r);
+		m_asm.and_(p, r32(moduloMask));
+		m_asm.sub(_r, p);
+		if(_n == 1)
+			m_asm.inc(p);
+		else
+			m_asm.dec(p);
+		m_asm.and_(p, r32(moduloMask));
+		m_asm.add(_r, p);
 	}
 
 	inline void JitOps::signed24To56(const JitReg64& _r) const
@@ -418,6 +557,27 @@ namespace dsp56k
 	{
 		m_block.asm_().mov(g_funcArgGPs[0], asmjit::Imm(&m_block.dsp()));
 		m_block.stack().call(asmjit::func_as_ptr(_func));
+
+		// the called function might modify any DSP register
+		m_block.dspRegPool().clearConstants();
+	}
+
+	void JitOps::setConstantAgu(const TWord _dddddd, const TWord _value) const
+	{
+		// 010TTT, 011NNN, 100FFF - R, N & M registers
+		const auto i = _dddddd & 0x3f;
+		if(i < 0x10 || i >= 0x28)
+			return;
+
+		m_block.dspRegPool().setConstant(static_cast<JitDspRegPool::DspReg>(JitDspRegPool::DspR0 + i - 0x10), _value);
+
+		if(i >= 0x20)
+			m_block.clearAguEntryValue(i - 0x20);
+	}
+
+	bool JitOps::getConstantM(TWord& _m, const TWord _rrr) const
+	{
+		return m_block.dspRegPool().getConstant(_m, static_cast<JitDspRegPool::DspReg>(JitDspRegPool::DspM0 + _rrr));
 	}
 
 	void JitOps::callDSPFunc(void(* _func)(DSP*, TWord), TWord _arg) const
@@ -16,7 +16,7 @@ namespace dsp56k
 		m_asm.cmp(r32(_m), r32(regReturnVal));
 		m_asm.jz(linear);
 
-		m_asm.tst(_m, asmjit::Imm(0xffff));						// bit reverse
+		m_asm.tst(_m, asmjit::Imm(0x7fff));						// bit reverse, M=$8000 has no modulo bits and is bit reverse, too
 		m_asm.cond_zero().b(bitreverse);
 
 		m_asm.and_(r32(regReturnVal), _m, asmjit::Imm(0xffff));
@@ -42,7 +42,7 @@ namespace dsp56k
 
 		// bitreverse:
 		m_asm.bind(bitreverse);
-		updateAddressRegisterBitreverse(_r, _n, _m);
+		updateAddressRegisterBitreverse(_r, _n);
 		m_asm.jmp(end);
 
 		// linear:
@@ -57,18 +57,20 @@ namespace dsp56k
 	{
 		const auto linear = m_asm.newLabel();
 		const auto modulo = m_asm.newLabel();
+		const auto bitreverse = m_asm.newLabel();
+		const auto multipleWrapModulo = m_asm.newLabel();
 		const auto end = m_asm.newLabel();
 
 		m_asm.mov(r32(regReturnVal), asmjit::Imm(0xffffff));		// linear shortcut
 		m_asm.cmp(r32(_m), r32(regReturnVal));
 		m_asm.jz(linear);
 
-		m_asm.tst(_m, asmjit::Imm(0xffff));							// bit reverse
-		m_asm.cond_zero().b(end);
+		m_asm.tst(_m, asmjit::Imm(0x7fff));							// bit reverse, M=$8000 has no modulo bits and is bit reverse, too
+		m_asm.cond_zero().b(bitreverse);
 
 		m_asm.and_(r32(regReturnVal), _m, asmjit::Imm(0xffff));		// multiple-wrap modulo
 		m_asm.cmp(r32(regReturnVal), asmjit::Imm(0x8000));
-		m_asm.cond_ge().b(end);
+		m_asm.cond_ge().b(multipleWrapModulo);
 
 		// modulo:
 		m_asm.bind(modulo);
@@ -78,10 +80,7 @@ namespace dsp56k
 			const auto& p64 = shifter;
 			const auto p = r32(p64.get());
 
-			m_asm.bsr(shifter, _m);								// returns index of MSB that is 1
-			m_asm.mov(moduloMask, asmjit::Imm(2));
-			m_asm.shl(moduloMask, shifter.get());
-			m_asm.dec(moduloMask);
+			calcModuloMask(r32(moduloMask), _m, shifter);
 
 			m_asm.mov(p, _r);
 			m_asm.and_(p, r32(moduloMask));
@@ -117,6 +116,16 @@ namespace dsp56k
 		}
 		m_asm.jmp(end);
 
+		// multiple-wrap modulo:
+		m_asm.bind(multipleWrapModulo);
+		updateAddressRegisterMultipleWrapModulo(_r, _n, _m);
+		m_asm.jmp(end);
+
+		// bitreverse: adding bitreverse(1) = $800000 in reversed order toggles the LSB only, the carry is lost
+		m_asm.bind(bitreverse);
+		m_asm.eor(_r, _r, asmjit::Imm(1));
+		m_asm.jmp(end);
+
 		// linear:
 		m_asm.bind(linear);
 
@@ -131,6 +140,66 @@ namespace dsp56k
 		m_asm.and_(_r, asmjit::Imm(0xffffff));
 	}
 
+	inline void JitOps::updateAddressRegisterBitreverse(const JitReg32& _r, const JitReg32& _n)
+	{
+		// reverse-carry: r = bitreverse(bitreverse(r) + bitreverse(n)), a negative n is subtracted
+		const auto sign = r32(regReturnVal);
+
+		m_asm.mov(sign, _n);
+		m_asm.cmp(_n, asmjit::Imm(0));
+		m_asm.cneg(_n, _n, asmjit::arm::CondCode::kLT);		// n = abs(n)
+
+		bitreverse24(_n);
+		bitreverse24(_r);
+
+		m_asm.cmp(sign, asmjit::Imm(0));
+		m_asm.cneg(_n, _n, asmjit::arm::CondCode::kLT);		// restore sign
+		m_asm.add(_r, _n);
+		m_asm.and_(_r, asmjit::Imm(0xffffff));
+
+		bitreverse24(_r);
+	}
+
+	inline void JitOps::bitreverse24(const JitReg32& _r) const
+	{
+		// the upper 8 bits are expected to be zero
+		m_asm.rbit(_r, _r);
+		m_asm.shr(_r, asmjit::Imm(8));
+	}
+
+	inline void JitOps::calcModuloMask(const JitReg32& _dst, const JitReg32& _m, const JitReg64& _temp)
+	{
+		// all bits up to and including the MSB of m, m must not be zero
+		m_asm.clz(r32(_temp), _m);
+		m_asm.mov(_dst, asmjit::Imm(0xffffffff));
+		m_asm.lsr(_dst, _dst, r32(_temp));
+	}
+
+	inline void JitOps::recordPMemWrite(const JitReg32& _ea, const JitReg64& _tempA, const JitReg64& _tempB)
+	{
+		// writes to pages that do not contain any code cannot invalidate anything
+		const auto skip = m_asm.newLabel();
+
+		m_block.mem().ptrToReg(_tempA, m_block.getCodePages());
+		m_asm.mov(r32(_tempB), _ea);
+		m_asm.shr(r32(_tempB), asmjit::Imm(JitCache::CodePageBits));
+		m_asm.ldrb(r32(_tempB), asmjit::arm::ptr(_tempA, _tempB));
+		m_asm.cbz(r32(_tempB), skip);
+
+		// extend the written range, the dispatcher invalidates it once the block returns
+		m_block.mem().mov(r32(_tempA), m_block.pMemWriteFirst());
+		m_asm.cmp(_ea, r32(_tempA));
+		m_asm.csel(r32(_tempA), _ea, r32(_tempA), asmjit::arm::CondCode::kLO);
+		m_block.mem().mov(m_block.pMemWriteFirst(), _tempA);
+
+		m_block.mem().mov(r32(_tempA), m_block.pMemWriteLast());
+		m_asm.cmp(_ea, r32(_tempA));
+		m_asm.csel(r32(_tempA), _ea, r32(_tempA), asmjit::arm::CondCode::kHI);
+		m_block.mem().mov(m_block.pMemWriteLast(), _tempA);
+
+		m_asm.bind(skip);
+	}
+
 	void JitOps::setALU0(const uint32_t _aluIndex, const JitRegGP& _src)
 	{
 		AluRef d(m_block, _aluIndex, true, true);
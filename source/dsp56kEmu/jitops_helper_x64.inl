@@ -15,11 +15,11 @@ namespace dsp56k
 		m_asm.cmp(r32(_m), asmjit::Imm(0xffffff));		// linear shortcut
 		m_asm.jz(linear);
 
-		m_asm.or_(_m.r16(), _m.r16());					// bit reverse
+		m_asm.test(_m.r16(), asmjit::Imm(0x7fff));		// bit reverse, M=$8000 has no modulo bits and is bit reverse, too
 		m_asm.jz(bitreverse);
 
 		m_asm.cmp(_m.r16(), asmjit::Imm(0x7fff));
-		m_asm.jg(multipleWrapModulo);
+		m_asm.ja(multipleWrapModulo);
 
 		const auto nAbs = r32(regReturnVal);			// compare abs(n) with m
 		m_asm.mov(nAbs, _n);
@@ -41,7 +41,7 @@ namespace dsp56k
 
 		// bitreverse:
 		m_asm.bind(bitreverse);
-		updateAddressRegisterBitreverse(_r, _n, _m);
+		updateAddressRegisterBitreverse(_r, _n);
 		m_asm.jmp(end);
 
 		// linear:
@@ -56,16 +56,18 @@ namespace dsp56k
 	{
 		const auto linear = m_asm.newLabel();
 		const auto modulo = m_asm.newLabel();
+		const auto bitreverse = m_asm.newLabel();
+		const auto multipleWrapModulo = m_asm.newLabel();
 		const auto end = m_asm.newLabel();
 
 		m_asm.cmp(r32(_m), asmjit::Imm(0xffffff));		// linear shortcut
 		m_asm.jz(linear);
 
-		m_asm.or_(_m.r16(), _m.r16());					// bit reverse
-		m_asm.jz(end);
+		m_asm.test(_m.r16(), asmjit::Imm(0x7fff));		// bit reverse, M=$8000 has no modulo bits and is bit reverse, too
+		m_asm.jz(bitreverse);
 
 		m_asm.cmp(_m.r16(), asmjit::Imm(0x7fff));
-		m_asm.jg(end);
+		m_asm.ja(multipleWrapModulo);
 
 		// modulo:
 		m_asm.bind(modulo);
@@ -75,10 +77,7 @@ namespace dsp56k
 			const auto& p64 = shifter;
 			const auto p = r32(p64.get());
 
-			m_asm.bsr(shifter, _m);								// returns index of MSB that is 1
-			m_asm.mov(moduloMask, asmjit::Imm(2));
-			m_asm.shl(moduloMask, shifter.get());
-			m_asm.dec(moduloMask);
+			calcModuloMask(r32(moduloMask), _m, shifter);
 
 			m_asm.mov(p, _r);
 			m_asm.and_(p, r32(moduloMask));
@@ -114,6 +113,16 @@ namespace dsp56k
 		}
 		m_asm.jmp(end);
 
+		// multiple-wrap modulo:
+		m_asm.bind(multipleWrapModulo);
+		updateAddressRegisterMultipleWrapModulo(_r, _n, _m);
+		m_asm.jmp(end);
+
+		// bitreverse: adding bitreverse(1) = $800000 in reversed order toggles the LSB only, the carry is lost
+		m_asm.bind(bitreverse);
+		m_asm.xor_(_r, asmjit::Imm(1));
+		m_asm.jmp(end);
+
 		// linear:
 		m_asm.bind(linear);
 
@@ -128,6 +137,93 @@ namespace dsp56k
 		m_asm.and_(_r, asmjit::Imm(0xffffff));
 	}
 
+	inline void JitOps::updateAddressRegisterBitreverse(const JitReg32& _r, const JitReg32& _n)
+	{
+		// reverse-carry: r = bitreverse(bitreverse(r) + bitreverse(n)), a negative n is subtracted
+		const ShiftReg sign64(m_block);
+		const auto sign = r32(sign64.get());
+
+		m_asm.mov(sign, _n);
+		m_asm.sar(sign, asmjit::Imm(31));
+		m_asm.xor_(_n, sign);
+		m_asm.sub(_n, sign);		// n = abs(n)
+
+		bitreverse24(_n);
+		bitreverse24(_r);
+
+		m_asm.xor_(_n, sign);
+		m_asm.sub(_n, sign);		// restore sign
+		m_asm.add(_r, _n);
+		m_asm.and_(_r, asmjit::Imm(0xffffff));
+
+		bitreverse24(_r);
+	}
+
+	inline void JitOps::bitreverse24(const JitReg32& _r) const
+	{
+		// reverse all 32 bits, the upper 8 bits are expected to be zero
+		const auto temp = r32(regReturnVal);
+
+		m_asm.bswap(_r);
+
+		// swap nibbles, bit pairs and single bits
+		for(uint32_t shift=4; shift > 0; shift >>= 1)
+		{
+			const uint32_t mask = shift == 4 ? 0x0f0f0f0f : (shift == 2 ? 0x33333333 : 0x55555555);
+
+			m_asm.mov(temp, _r);
+			m_asm.shr(temp, asmjit::Imm(shift));
+			m_asm.and_(temp, asmjit::Imm(mask));
+			m_asm.and_(_r, asmjit::Imm(mask));
+			m_asm.shl(_r, asmjit::Imm(shift));
+			m_asm.or_(_r, temp);
+		}
+
+		m_asm.shr(_r, asmjit::Imm(8));
+	}
+
+	inline void JitOps::calcModuloMask(const JitReg32& _dst, const JitReg32& _m, const JitReg64& _temp)
+	{
+		// all bits up to and including the MSB of m, m must not be zero. Without BMI2, _temp needs to be the shift register
+		if(JitEmitter::hasLZCNT() && JitEmitter::hasBMI2())
+		{
+			m_asm.lzcnt(r32(_temp), _m);
+			m_asm.mov(_dst, asmjit::Imm(0xffffffff));
+			m_asm.shrx(_dst, _dst, r32(_temp));
+			return;
+		}
+
+		m_asm.bsr(r32(_temp), _m);						// returns index of MSB that is 1
+		m_asm.mov(_dst, asmjit::Imm(2));
+		m_asm.shl(_dst, _temp);
+		m_asm.dec(_dst);
+	}
+
+	inline void JitOps::recordPMemWrite(const JitReg32& _ea, const JitReg64& _tempA, const JitReg64& _tempB)
+	{
+		// writes to pages that do not contain any code cannot invalidate anything
+		const auto skip = m_asm.newLabel();
+
+		m_block.mem().ptrToReg(_tempA, m_block.getCodePages());
+		m_asm.mov(r32(_tempB), _ea);
+		m_asm.shr(r32(_tempB), asmjit::Imm(JitCache::CodePageBits));
+		m_asm.cmp(asmjit::x86::byte_ptr(_tempA, _tempB), asmjit::Imm(0));
+		m_asm.jz(skip);
+
+		// extend the written range, the dispatcher invalidates it once the block returns
+		m_block.mem().mov(r32(_tempA), m_block.pMemWriteFirst());
+		m_asm.cmp(_ea, r32(_tempA));
+		m_asm.cmovb(r32(_tempA), _ea);
+		m_block.mem().mov(m_block.pMemWriteFirst(), _tempA);
+
+		m_block.mem().mov(r32(_tempA), m_block.pMemWriteLast());
+		m_asm.cmp(_ea, r32(_tempA));
+		m_asm.cmova(r32(_tempA), _ea);
+		m_block.mem().mov(m_block.pMemWriteLast(), _tempA);
+
+		m_asm.bind(skip);
+	}
+
 	void JitOps::setALU0(const uint32_t _aluIndex, const JitRegGP& _src)
 	{
 		const RegGP maskedSource(m_block);
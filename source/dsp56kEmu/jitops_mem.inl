@@ -36,6 +36,31 @@ namespace dsp56k
 		return effectiveAddressType<Inst>(_op);
 	}
 
+	template <Instruction Inst, typename std::enable_if<hasFields<Inst, Field_MMM, Field_RRR>()>::type*> bool JitOps::effectiveAddressConstant(TWord& _addr, const TWord _op)
+	{
+		// (Rn), (Rn)+ and (Rn)- access the address before Rn is updated. If Rn has been set to an immediate value
+		// before in this block, the address is known at compile time and the range checks can be skipped
+		const TWord mmm = getFieldValue<Inst, Field_MMM>(_op);
+		const TWord rrr = getFieldValue<Inst, Field_RRR>(_op);
+
+		if(mmm != 2 && mmm != 3 && mmm != 4)
+			return false;
+
+		if(!m_block.dspRegPool().getConstant(_addr, static_cast<JitDspRegPool::DspReg>(JitDspRegPool::DspR0 + rrr)))
+			return false;
+
+		// dynamic addressing never reaches peripherals and out of range accesses are skipped, keep that behaviour
+		if(_addr >= m_block.dsp().memory().size())
+			return false;
+
+		if(mmm != 4)
+		{
+			const RegGP unused(m_block);
+			updateAddressRegister(unused, mmm, rrr);
+		}
+		return true;
+	}
+
 	template <Instruction Inst, typename std::enable_if<!hasField<Inst,Field_s>() && hasFields<Inst, Field_MMM, Field_RRR, Field_S>()>::type*> void JitOps::readMem(const JitReg64& _dst, const TWord _op)
 	{
 		readMem<Inst>(_dst, _op, getFieldValueMemArea<Inst>(_op));
@@ -57,6 +82,14 @@ namespace dsp56k
 			m_block.mem().readPeriph(_dst, _area, getOpWordB());
 			break;
 		case Dynamic:
+			{
+				TWord addr;
+				if(effectiveAddressConstant<Inst>(addr, _op))
+				{
+					m_block.mem().readDspMemory(_dst, _area, addr);
+					break;
+				}
+			}
 			effectiveAddress<Inst>(_dst, _op);
 			readMemOrPeriph(_dst, _area, _dst);
 			break;
@@ -68,15 +101,13 @@ namespace dsp56k
 	{
 		const auto area = getFieldValueMemArea<Inst>(op);
 		const auto offset = getFieldValue<Inst,Field_qqqqqq>(op);
-		m_asm.mov(_dst, asmjit::Imm(offset + 0xffff80));
-		m_block.mem().readPeriph(_dst, area, _dst);
+		m_block.mem().readPeriph(_dst, area, static_cast<TWord>(offset + 0xffff80));
 	}
 	template <Instruction Inst, typename std::enable_if<!hasAnyField<Inst, Field_MMM, Field_RRR>() && hasFields<Inst, Field_pppppp, Field_S>()>::type*> void JitOps::readMem(const JitReg64& _dst, TWord op) const
 	{
 		const auto area = getFieldValueMemArea<Inst>(op);
 		const auto offset = getFieldValue<Inst,Field_pppppp>(op);
-		m_asm.mov(_dst, asmjit::Imm(offset + 0xffffc0));
-		m_block.mem().readPeriph(_dst, area, _dst);	
+		m_block.mem().readPeriph(_dst, area, static_cast<TWord>(offset + 0xffffc0));
 	}
 	template <Instruction Inst, typename std::enable_if<!hasField<Inst, Field_s>() && hasFields<Inst, Field_aaaaaa, Field_S>()>::type*> void JitOps::readMem(const JitReg64& _dst, TWord op) const
 	{
@@ -119,6 +150,13 @@ namespace dsp56k
 			break;
 		case Dynamic:
 			{
+				TWord addr;
+				if(effectiveAddressConstant<Inst>(addr, _op))
+				{
+					m_block.mem().writeDspMemory(_area, addr, _src);
+					break;
+				}
+
 				const RegGP offset(m_block);
 				effectiveAddress<Inst>(offset, _op);
 				writeMemOrPeriph(_area, offset, _src);				
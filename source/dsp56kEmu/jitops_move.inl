@@ -14,6 +14,7 @@ namespace dsp56k
 		const RegGP i(m_block);
 		m_asm.mov(r32(i.get()), asmjit::Imm(iiiiiiii));
 		decode_dddddd_write(ddddd, r32(i.get()), true);
+		setConstantAgu(ddddd, iiiiiiii);
 	}
 
 	void JitOps::op_Mover(TWord op)
@@ -46,8 +47,10 @@ namespace dsp56k
 
 		if (write)
 		{
-			readMem<Inst>(r, _op, _area);
+			const auto eaType = readMem<Inst>(r, _op, _area);
 			decode_dddddd_write(ddddd, r32(r.get()));
+			if(eaType == Immediate)
+				setConstantAgu(ddddd, m_opWordB & 0xffffff);
 		}
 		else
 		{
@@ -391,6 +394,9 @@ namespace dsp56k
 			readMem<Movec_ea>(r, op);
 
 			decode_ddddd_pcr_write( ddddd, r32(r.get()));
+
+			if((ddddd & 0x18) == 0x00 && effectiveAddressType<Movec_ea>(op) == Immediate)
+				setConstantAgu(0x20 + (ddddd & 0x07), m_opWordB & 0xffffff);
 		}
 		else
 		{
@@ -449,6 +455,9 @@ namespace dsp56k
 		const RegGP r(m_block);
 		m_asm.mov(r32(r.get()), asmjit::Imm(iiiiiiii));
 		decode_ddddd_pcr_write( ddddd, r32(r.get()));
+
+		if((ddddd & 0x18) == 0x00)
+			setConstantAgu(0x20 + (ddddd & 0x07), iiiiiiii);
 	}
 
 	inline void JitOps::op_Movem_ea(TWord op)
@@ -478,8 +487,7 @@ namespace dsp56k
 
 			m_block.mem().writeDspMemory(MemArea_P, ea, r);
 
-			m_block.mem().mov(m_block.pMemWriteAddress(), r32(ea.get()));
-			m_block.mem().mov(m_block.pMemWriteValue(), r32(r.get()));
+			recordPMemWrite(r32(ea.get()), compare, r);
 
 			m_asm.bind(skip);
 
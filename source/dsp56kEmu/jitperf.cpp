@@ -0,0 +1,205 @@
+#include "jitperf.h"
+
+#include "buildconfig.h"
+#include "logging.h"
+
+#ifdef __linux__
+#include <ctime>
+
+#include <elf.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace dsp56k
+{
+#ifdef __linux__
+	namespace
+	{
+		// see tools/perf/Documentation/jitdump-specification.txt in the Linux kernel source
+		constexpr uint32_t g_jitDumpMagic = 0x4A695444;
+		constexpr uint32_t g_jitDumpVersion = 1;
+		constexpr uint32_t g_jitCodeLoad = 0;
+		constexpr uint32_t g_jitCodeClose = 3;
+
+		struct JitDumpHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t totalSize;
+			uint32_t elfMach;
+			uint32_t pad1;
+			uint32_t pid;
+			uint64_t timestamp;
+			uint64_t flags;
+		};
+
+		struct JitDumpRecordHeader
+		{
+			uint32_t id;
+			uint32_t totalSize;
+			uint64_t timestamp;
+		};
+
+		struct JitDumpCodeLoad
+		{
+			JitDumpRecordHeader header;
+			uint32_t pid;
+			uint32_t tid;
+			uint64_t vma;
+			uint64_t codeAddr;
+			uint64_t codeSize;
+			uint64_t codeIndex;
+		};
+
+		uint64_t timestamp()
+		{
+			// perf record -k mono uses the same clock
+			timespec ts{};
+			clock_gettime(CLOCK_MONOTONIC, &ts);
+			return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+		}
+	}
+#endif
+
+	JitPerf::~JitPerf()
+	{
+		close();
+	}
+
+	bool JitPerf::open(const uint32_t _outputs, const std::string& _jitDumpDir/* = "/tmp"*/)
+	{
+		close();
+
+#ifdef __linux__
+		if(_outputs & PerfMap)
+		{
+			const auto name = "/tmp/perf-" + std::to_string(getpid()) + ".map";
+
+			m_perfMap = fopen(name.c_str(), "a");
+
+			if(!m_perfMap)
+				LOG("Failed to open " << name << " for writing");
+		}
+
+		if(_outputs & JitDump)
+			openJitDump(_jitDumpDir);
+
+		m_outputs = (m_perfMap ? PerfMap : None) | (m_jitDump ? JitDump : None);
+#endif
+		return m_outputs == _outputs && _outputs != None;
+	}
+
+	void JitPerf::close()
+	{
+		if(m_perfMap)
+		{
+			fclose(m_perfMap);
+			m_perfMap = nullptr;
+		}
+
+		closeJitDump();
+
+		m_outputs = None;
+	}
+
+	void JitPerf::notifyCodeLoad(const void* _code, const size_t _size, const std::string& _name)
+	{
+		if(m_perfMap)
+		{
+			fprintf(m_perfMap, "%llx %llx %s\n", static_cast<unsigned long long>(reinterpret_cast<uintptr_t>(_code)), static_cast<unsigned long long>(_size), _name.c_str());
+			fflush(m_perfMap);
+		}
+
+#ifdef __linux__
+		if(m_jitDump)
+		{
+			JitDumpCodeLoad r{};
+
+			r.header.id = g_jitCodeLoad;
+			r.header.totalSize = static_cast<uint32_t>(sizeof(r) + _name.size() + 1 + _size);
+			r.header.timestamp = timestamp();
+			r.pid = static_cast<uint32_t>(getpid());
+			r.tid = static_cast<uint32_t>(syscall(SYS_gettid));
+			r.vma = reinterpret_cast<uintptr_t>(_code);
+			r.codeAddr = r.vma;
+			r.codeSize = _size;
+			r.codeIndex = m_codeIndex++;
+
+			fwrite(&r, sizeof(r), 1, m_jitDump);
+			fwrite(_name.c_str(), _name.size() + 1, 1, m_jitDump);
+			fwrite(_code, _size, 1, m_jitDump);
+			fflush(m_jitDump);
+		}
+#endif
+	}
+
+	bool JitPerf::openJitDump(const std::string& _dir)
+	{
+#ifdef __linux__
+		const auto name = _dir + "/jit-" + std::to_string(getpid()) + ".dump";
+
+		m_jitDump = fopen(name.c_str(), "w+b");
+
+		if(!m_jitDump)
+		{
+			LOG("Failed to open " << name << " for writing");
+			return false;
+		}
+
+		// perf record finds the dump file by looking for an executable mapping of it
+		m_jitDumpMarkerSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+		m_jitDumpMarker = mmap(nullptr, m_jitDumpMarkerSize, PROT_READ | PROT_EXEC, MAP_PRIVATE, fileno(m_jitDump), 0);
+
+		if(m_jitDumpMarker == MAP_FAILED)
+		{
+			LOG("Failed to map " << name);
+			m_jitDumpMarker = nullptr;
+			fclose(m_jitDump);
+			m_jitDump = nullptr;
+			return false;
+		}
+
+		JitDumpHeader h{};
+		h.magic = g_jitDumpMagic;
+		h.version = g_jitDumpVersion;
+		h.totalSize = sizeof(h);
+#ifdef HAVE_ARM64
+		h.elfMach = EM_AARCH64;
+#else
+		h.elfMach = EM_X86_64;
+#endif
+		h.pid = static_cast<uint32_t>(getpid());
+		h.timestamp = timestamp();
+
+		fwrite(&h, sizeof(h), 1, m_jitDump);
+		fflush(m_jitDump);
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	void JitPerf::closeJitDump()
+	{
+#ifdef __linux__
+		if(!m_jitDump)
+			return;
+
+		JitDumpRecordHeader r{};
+		r.id = g_jitCodeClose;
+		r.totalSize = sizeof(r);
+		r.timestamp = timestamp();
+		fwrite(&r, sizeof(r), 1, m_jitDump);
+
+		if(m_jitDumpMarker)
+			munmap(m_jitDumpMarker, m_jitDumpMarkerSize);
+
+		m_jitDumpMarker = nullptr;
+
+		fclose(m_jitDump);
+		m_jitDump = nullptr;
+#endif
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace dsp56k
+{
+	// Announces generated code to the Linux perf tool so that host cycles can be attributed to DSP code.
+	// PerfMap appends to /tmp/perf-<pid>.map, which is read by perf top and perf report.
+	// JitDump writes jit-<pid>.dump to the given directory, use perf record -k mono and perf inject --jit to merge it.
+	// Does nothing on other platforms
+	class JitPerf
+	{
+	public:
+		enum Output
+		{
+			None		= 0,
+			PerfMap		= 0x01,
+			JitDump		= 0x02,
+		};
+
+		JitPerf() = default;
+		~JitPerf();
+
+		JitPerf(const JitPerf&) = delete;
+		JitPerf& operator = (const JitPerf&) = delete;
+
+		bool open(uint32_t _outputs, const std::string& _jitDumpDir = "/tmp");
+		void close();
+
+		bool isOpen() const { return m_perfMap != nullptr || m_jitDump != nullptr; }
+		uint32_t getOutputs() const { return m_outputs; }
+
+		void notifyCodeLoad(const void* _code, size_t _size, const std::string& _name);
+
+	private:
+		bool openJitDump(const std::string& _dir);
+		void closeJitDump();
+
+		uint32_t m_outputs = None;
+
+		FILE* m_perfMap = nullptr;
+		FILE* m_jitDump = nullptr;
+		void* m_jitDumpMarker = nullptr;
+		size_t m_jitDumpMarkerSize = 0;
+		uint64_t m_codeIndex = 0;
+	};
+}
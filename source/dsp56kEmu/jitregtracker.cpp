@@ -139,6 +139,23 @@ namespace dsp56k
 			m_block.stack().pop(m_reg);
 	}
 
+#ifdef HAVE_X86_64
+	ShiftReg::ShiftReg(JitBlock& _block) : m_block(_block), m_reg(regShiftCount), m_isTemp(JitEmitter::hasBMI2())
+	{
+		if(!m_isTemp)
+			return;
+
+		m_reg = m_block.gpPool().get().as<JitReg64>();
+		m_block.stack().setUsed(m_reg);
+	}
+
+	ShiftReg::~ShiftReg()
+	{
+		if(m_isTemp)
+			m_block.gpPool().put(m_reg);
+	}
+#endif
+
 	PushXMM::PushXMM(JitBlock& _block, uint32_t _xmmIndex) : m_block(_block), m_xmmIndex(_xmmIndex), m_isLoaded(m_block.dspRegPool().isInUse(JitReg128(_xmmIndex)))
 	{
 		if(!m_isLoaded)
@@ -198,6 +215,15 @@ namespace dsp56k
 			}
 		}
 
+#if defined(HAVE_X86_64) && !defined(_MSC_VER)
+		// the shift register may be part of the DSP register pool, but as a function argument it is skipped above
+		if(_block.dspRegPool().isInUse(regShiftCount))
+		{
+			m_pushedRegs.push_front(regShiftCount);
+			_block.stack().push(regShiftCount);
+		}
+#endif
+
 #ifdef HAVE_ARM64
 		_block.stack().push(asmjit::a64::regs::x30);
 		m_pushedRegs.push_front(asmjit::a64::regs::x30);
@@ -188,10 +188,24 @@ namespace dsp56k
 	};
 
 #ifdef HAVE_X86_64
-	class ShiftReg : public PushGP
+	// Holds the count of a shift by register. Without BMI2, this is the shift register, which is not part of the DSP
+	// register pool then. With BMI2, any temp can be used
+	class ShiftReg
 	{
 	public:
-		ShiftReg(JitBlock& _block) : PushGP(_block, asmjit::x86::rcx, true) {}
+		ShiftReg(JitBlock& _block);
+		~ShiftReg();
+
+		ShiftReg(const ShiftReg&) = delete;
+		ShiftReg& operator = (const ShiftReg&) = delete;
+
+		const JitReg64& get() const { return m_reg; }
+		operator const JitReg64& () const { return m_reg; }
+
+	private:
+		JitBlock& m_block;
+		JitReg64 m_reg;
+		const bool m_isTemp;
 	};
 #else
 	using ShiftReg = RegGP;
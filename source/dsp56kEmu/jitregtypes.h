@@ -26,6 +26,11 @@ namespace dsp56k
 
 	static constexpr auto regXMMTempA = asmjit::arm::VecV(1);
 
+	// Host registers that keep DSP registers across blocks if pinning is enabled, see Jit::setPinDspRegs. The scratch register is used to address the DSP registers when they are loaded or stored
+	static constexpr JitRegGP g_dspPinnedGps[] = {JitReg64(19), JitReg64(20), JitReg64(21)};
+
+	static constexpr auto regPinnedScratch = JitReg64(30);
+
 	static constexpr JitReg128 g_dspPoolXmms[] = {									JitReg128(2) ,  JitReg128(3) , JitReg128(4) , JitReg128(5) , JitReg128(6) , JitReg128(7),
 												   JitReg128(8) , JitReg128(9) ,  JitReg128(10),  JitReg128(11), JitReg128(12), JitReg128(13), JitReg128(14), JitReg128(15),
 												   JitReg128(16), JitReg128(17),  JitReg128(18),  JitReg128(19), JitReg128(20), JitReg128(21), JitReg128(22), JitReg128(23),
@@ -48,7 +53,7 @@ namespace dsp56k
 #else
 	static constexpr JitReg64 g_funcArgGPs[] = { asmjit::x86::rdi, asmjit::x86::rsi, asmjit::x86::rdx, asmjit::x86::rcx };
 
-	// Note: rcx is not used in any pools because it is needed as shift register
+	// Note: rcx is not in the pool below as it is needed as shift register on hosts without BMI2, see JitDspRegPool::clear
 
 	static constexpr JitReg64 g_nonVolatileGPs[] = { asmjit::x86::rbx, asmjit::x86::rbp, asmjit::x86::rsi// not needed, asmjit::x86::rsp
 	                                               , asmjit::x86::r12, asmjit::x86::r13, asmjit::x86::r14, asmjit::x86::r15};
@@ -61,12 +66,20 @@ namespace dsp56k
 
 	static constexpr auto regReturnVal = asmjit::x86::rax;
 
+	// Shifts by a register need their count in cl if the host has no BMI2, see ShiftReg
+	static constexpr auto regShiftCount = asmjit::x86::rcx;
+
 	static constexpr std::initializer_list<JitReg> g_regGPTemps = { asmjit::x86::r12, asmjit::x86::r13, asmjit::x86::r14, asmjit::x86::r15, asmjit::x86::rbp };
 
 	static constexpr auto regLastModAlu = asmjit::x86::xmm0;
 
 	static constexpr auto regXMMTempA = asmjit::x86::xmm1;
 
+	// Host registers that keep DSP registers across blocks if pinning is enabled, see Jit::setPinDspRegs. The scratch register is used to address the DSP registers when they are loaded or stored
+	static constexpr JitRegGP g_dspPinnedGps[] = { asmjit::x86::rbx };
+
+	static constexpr auto regPinnedScratch = asmjit::x86::r11;
+
 	static constexpr JitReg128 g_dspPoolXmms[] =	{ asmjit::x86::xmm2, asmjit::x86::xmm3,  asmjit::x86::xmm4,  asmjit::x86::xmm5,  asmjit::x86::xmm6,  asmjit::x86::xmm7,  asmjit::x86::xmm8,
 													  asmjit::x86::xmm9, asmjit::x86::xmm10, asmjit::x86::xmm11, asmjit::x86::xmm12, asmjit::x86::xmm13, asmjit::x86::xmm14, asmjit::x86::xmm15};
 
@@ -2,6 +2,8 @@
 
 #include "types.h"
 
+#include <atomic>
+
 namespace dsp56k
 {
 	constexpr TWord g_pcInvalid = 0xffffffff;
@@ -10,7 +12,12 @@ namespace dsp56k
 	{
 		TWord m_executedInstructionCount = 0;
 		TWord m_nextPC = g_pcInvalid;
-		TWord m_pMemWriteAddress = g_pcInvalid;
-		TWord m_pMemWriteValue = 0;
+		TWord m_pMemWriteFirst = g_pcInvalid;	// range of P addresses in code pages that have been written by a block, g_pcInvalid if none
+		TWord m_pMemWriteLast = 0;
+		std::atomic<uint32_t> m_interruptPending{0};	// set if an interrupt has been injected, possibly by another thread. Polled by JIT code at block boundaries and loop back edges
+		TWord m_aguGuardFailed = g_pcInvalid;	// entry PC of a block that has been left because an M register did not have the expected value
+		uint64_t m_epoch = 0;					// incremented by the dispatcher, JIT code stores it in every block that it enters
 	};
+
+	static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "JIT code reads the interrupt flag as plain 32 bit value");
 }
@@ -38,7 +38,21 @@ namespace dsp56k
 	void JitStackHelper::pushNonVolatiles()
 	{
 		for (const auto& reg : g_nonVolatileGPs)
+		{
+			// pinned registers are live across blocks, restoring them would discard what the block wrote
+			if(m_block.hasPinnedDspRegs() && JitDspRegPool::isPinnedHostReg(reg))
+				continue;
 			setUsed(reg);
+		}
+	}
+
+	void JitStackHelper::pushNonVolatileXMMs()
+	{
+		for (const auto& reg : g_nonVolatileXMMs)
+		{
+			if(reg.isValid())
+				setUsed(reg);
+		}
 	}
 
 	void JitStackHelper::push(const JitRegGP& _reg)
@@ -115,8 +129,15 @@ namespace dsp56k
 #endif
 		}
 
+		// the function might read or modify the DSP registers that are kept in host registers
+		if(m_block.hasPinnedDspRegs())
+			JitDspRegPool::storePinned(m_block.asm_(), m_block.dsp(), regPinnedScratch);
+
 		m_block.asm_().call(_funcAsPtr);
 
+		if(m_block.hasPinnedDspRegs())
+			JitDspRegPool::loadPinned(m_block.asm_(), m_block.dsp(), regPinnedScratch);
+
 		if(offset)
 #ifdef HAVE_ARM64
 			m_block.asm_().add(asmjit::a64::regs::sp, asmjit::a64::regs::sp, asmjit::Imm(offset));
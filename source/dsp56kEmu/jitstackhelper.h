@@ -26,6 +26,7 @@ namespace dsp56k
 		void popAll();
 
 		void pushNonVolatiles();
+		void pushNonVolatileXMMs();
 		
 		void call(const void* _funcAsPtr) const;
 		
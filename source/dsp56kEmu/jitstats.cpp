@@ -0,0 +1,75 @@
+#include "jitstats.h"
+
+namespace dsp56k
+{
+	void JitStatsCounters::addCompiledBlock(const uint64_t _compileTimeUs)
+	{
+		add(m_blocksCompiled);
+		add(m_compileTimeTotalUs, _compileTimeUs);
+		add(m_compileTimeUs[getBucket(_compileTimeUs)]);
+	}
+
+	void JitStatsCounters::addInstalledBlock(const uint32_t _instructionCount, const size_t _codeSize)
+	{
+		add(m_instructionsPerBlock[getBucket(_instructionCount)]);
+		add(m_codeSize, _codeSize);
+	}
+
+	void JitStatsCounters::removeBlock(const size_t _codeSize)
+	{
+		m_codeSize.fetch_sub(_codeSize, std::memory_order_relaxed);
+	}
+
+	JitStats JitStatsCounters::get() const
+	{
+		JitStats s;
+
+		s.blocksCompiled = read(m_blocksCompiled);
+		s.compileTimeTotalUs = read(m_compileTimeTotalUs);
+
+		for(size_t i=0; i<JitStats::HistogramSize; ++i)
+		{
+			s.compileTimeUs[i] = read(m_compileTimeUs[i]);
+			s.instructionsPerBlock[i] = read(m_instructionsPerBlock[i]);
+		}
+
+		s.codeSize = read(m_codeSize);
+		s.recreates = read(m_recreates);
+		s.singleOpCacheHits = read(m_singleOpCacheHits);
+		s.pMemWriteInvalidations = read(m_pMemWriteInvalidations);
+		s.evictedBlocks = read(m_evictedBlocks);
+
+		return s;
+	}
+
+	void JitStatsCounters::reset()
+	{
+		// the code size describes the current state, it is not reset
+		m_blocksCompiled = 0;
+		m_compileTimeTotalUs = 0;
+
+		for(size_t i=0; i<JitStats::HistogramSize; ++i)
+		{
+			m_compileTimeUs[i] = 0;
+			m_instructionsPerBlock[i] = 0;
+		}
+
+		m_recreates = 0;
+		m_singleOpCacheHits = 0;
+		m_pMemWriteInvalidations = 0;
+		m_evictedBlocks = 0;
+	}
+
+	size_t JitStatsCounters::getBucket(uint64_t _value)
+	{
+		size_t bucket = 0;
+
+		while(_value && bucket < JitStats::HistogramSize - 1)
+		{
+			_value >>= 1;
+			++bucket;
+		}
+
+		return bucket;
+	}
+}
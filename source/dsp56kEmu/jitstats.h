@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace dsp56k
+{
+	// Snapshot of the JIT counters, see Jit::getStats
+	struct JitStats
+	{
+		// Bucket 0 counts zero, bucket i > 0 counts values in the range [2^(i-1), 2^i), the last bucket counts everything above
+		static constexpr size_t HistogramSize = 16;
+		using Histogram = std::array<uint64_t, HistogramSize>;
+
+		uint64_t blocksCompiled = 0;
+		uint64_t compileTimeTotalUs = 0;
+		Histogram compileTimeUs{};			// per block, in microseconds
+		Histogram instructionsPerBlock{};	// DSP instructions per installed block
+
+		uint64_t codeSize = 0;				// host code bytes of all installed blocks, including cached 1-word-ops
+		uint64_t recreates = 0;				// blocks that have been destroyed because they have been entered in the middle
+		uint64_t singleOpCacheHits = 0;		// 1-word-ops that have been reused instead of being compiled again
+		uint64_t pMemWriteInvalidations = 0;	// P memory writes that hit generated code
+		uint64_t evictedBlocks = 0;			// blocks that have been discarded to stay within the code budget
+	};
+
+	// Counters are written by the DSP thread and the compile thread and can be read from any thread at any time
+	class JitStatsCounters
+	{
+	public:
+		void addCompiledBlock(uint64_t _compileTimeUs);
+		void addInstalledBlock(uint32_t _instructionCount, size_t _codeSize);
+		void removeBlock(size_t _codeSize);
+		void addRecreate() { add(m_recreates); }
+		void addSingleOpCacheHit() { add(m_singleOpCacheHits); }
+		void addPMemWriteInvalidation() { add(m_pMemWriteInvalidations); }
+		void addEvictedBlocks(const uint64_t _count) { add(m_evictedBlocks, _count); }
+
+		JitStats get() const;
+		void reset();
+
+		static size_t getBucket(uint64_t _value);
+
+	private:
+		using Counter = std::atomic<uint64_t>;
+		using Histogram = std::array<Counter, JitStats::HistogramSize>;
+
+		static void add(Counter& _counter, const uint64_t _value = 1) { _counter.fetch_add(_value, std::memory_order_relaxed); }
+		static uint64_t read(const Counter& _counter) { return _counter.load(std::memory_order_relaxed); }
+
+		Counter m_blocksCompiled{0};
+		Counter m_compileTimeTotalUs{0};
+		Histogram m_compileTimeUs{};
+		Histogram m_instructionsPerBlock{};
+
+		Counter m_codeSize{0};
+		Counter m_recreates{0};
+		Counter m_singleOpCacheHits{0};
+		Counter m_pMemWriteInvalidations{0};
+		Counter m_evictedBlocks{0};
+	};
+}
@@ -23,6 +23,9 @@ namespace dsp56k
 		runTest(&JitUnittests::agu_build, &JitUnittests::agu_verify);
 		runTest(&JitUnittests::agu_modulo_build, &JitUnittests::agu_modulo_verify);
 		runTest(&JitUnittests::agu_modulo2_build, &JitUnittests::agu_modulo2_verify);
+		runTest(&JitUnittests::agu_moduloConst_build, &JitUnittests::agu_moduloConst_verify);
+		runTest(&JitUnittests::agu_multiWrapModulo_build, &JitUnittests::agu_multiWrapModulo_verify);
+		runTest(&JitUnittests::agu_bitreverse_build, &JitUnittests::agu_bitreverse_verify);
 
 		runTest(&JitUnittests::transferSaturation_build, &JitUnittests::transferSaturation_verify);
 
@@ -72,8 +75,10 @@ namespace dsp56k
 
 		runTest(&JitUnittests::btst_aa_build, &JitUnittests::btst_aa_verify);
 
+		clb();
 		clr();
 		cmp();
+		cmpu();
 		dec();
 		div();
 		rep_div();
@@ -91,14 +96,25 @@ namespace dsp56k
 		mpyr();
 		mpy_SD();
 		neg();
+		norm();
+		normf();
 		not_();
 		or_();
 		rnd();
 		rol();
 		sub();
 		tfr();
+		wait();
 		move();
 		parallel();
+
+		interpretedOps();
+
+		idleLoop();
+
+		periphDirectAccess();
+
+		codeBudget();
 		
 		runTest(&JitUnittests::ori_build, &JitUnittests::ori_verify);
 		
@@ -492,6 +508,105 @@ namespace dsp56k
 		assert(m_checks[7] == 0x71);
 	}
 
+	void JitUnittests::agu_moduloConst_build(JitBlock& _block, JitOps& _ops)
+	{
+		dsp.regs().r[0].var = 0x102;
+
+		_ops.emit(0, 0x05f420, 0x000003);	// movec #$3,m0, M is known at compile time now
+
+		const RegGP temp(_block);
+
+		for(size_t i=0; i<8; ++i)
+		{
+			_ops.updateAddressRegister(temp.get(), i < 4 ? MMM_RnPlus : MMM_RnMinus, 0);
+			_block.regs().getR(temp, 0);
+			_block.mem().mov(m_checks[i], temp);
+		}
+	}
+
+	void JitUnittests::agu_moduloConst_verify()
+	{
+		assert(m_checks[0] == 0x103);
+		assert(m_checks[1] == 0x100);
+		assert(m_checks[2] == 0x101);
+		assert(m_checks[3] == 0x102);
+		assert(m_checks[4] == 0x101);
+		assert(m_checks[5] == 0x100);
+		assert(m_checks[6] == 0x103);
+		assert(m_checks[7] == 0x102);
+	}
+
+	void JitUnittests::agu_multiWrapModulo_build(JitBlock& _block, JitOps& _ops)
+	{
+		dsp.regs().r[0].var = 0x100;
+		dsp.regs().n[0].var = 0x17;
+		dsp.regs().m[0].var = 0x800f;
+
+		const RegGP temp(_block);
+
+		for(size_t i=0; i<8; ++i)
+		{
+			_ops.updateAddressRegister(temp.get(), MMM_RnPlusNn, 0);
+			_block.regs().getR(temp, 0);
+			_block.mem().mov(m_checks[i], temp);
+		}
+	}
+
+	void JitUnittests::agu_multiWrapModulo_verify()
+	{
+		assert(m_checks[0] == 0x107);
+		assert(m_checks[1] == 0x10e);
+		assert(m_checks[2] == 0x105);
+		assert(m_checks[3] == 0x10c);
+		assert(m_checks[4] == 0x103);
+		assert(m_checks[5] == 0x10a);
+		assert(m_checks[6] == 0x101);
+		assert(m_checks[7] == 0x108);
+	}
+
+	void JitUnittests::agu_bitreverse_build(JitBlock& _block, JitOps& _ops)
+	{
+		dsp.regs().r[0].var = 0x1000;
+		dsp.regs().n[0].var = 0x200;
+		dsp.regs().m[0].var = 0;
+
+		const RegGP temp(_block);
+
+		for(size_t i=0; i<8; ++i)
+		{
+			_ops.updateAddressRegister(temp.get(), MMM_RnPlusNn, 0);
+			_block.regs().getR(temp, 0);
+			_block.mem().mov(m_checks[i], temp);
+		}
+
+		_ops.updateAddressRegister(temp.get(), MMM_RnPlus, 0);
+		_block.regs().getR(temp, 0);
+		_block.mem().mov(m_checks[8], temp);
+
+		// M=$8000 is multiple-wrap modulo without any modulo bits, the interpreter uses bit reverse for it
+		dsp.regs().r[1].var = 0x1000;
+		dsp.regs().n[1].var = 0x200;
+		dsp.regs().m[1].var = 0x8000;
+
+		_ops.updateAddressRegister(temp.get(), MMM_RnPlusNn, 1);
+		_block.regs().getR(temp, 1);
+		_block.mem().mov(m_checks[9], temp);
+	}
+
+	void JitUnittests::agu_bitreverse_verify()
+	{
+		assert(m_checks[0] == 0x1200);
+		assert(m_checks[1] == 0x1100);
+		assert(m_checks[2] == 0x1300);
+		assert(m_checks[3] == 0x1080);
+		assert(m_checks[4] == 0x1280);
+		assert(m_checks[5] == 0x1180);
+		assert(m_checks[6] == 0x1380);
+		assert(m_checks[7] == 0x1040);
+		assert(m_checks[8] == 0x1041);
+		assert(m_checks[9] == 0x1200);
+	}
+
 	void JitUnittests::transferSaturation_build(JitBlock& _block, JitOps& _ops)
 	{
 		const RegGP temp(_block);
@@ -1261,6 +1376,80 @@ namespace dsp56k
 		assert((m_checks[1] & CCR_C) != 0);
 	}
 
+	void JitUnittests::clb()
+	{
+		runTest([&](auto& _block, auto& _ops)
+		{
+			dsp.regs().a.var = 0x00000001000000;
+			dsp.regs().b.var = 0x12345678abcdef;
+			_ops.emit(0, 0x0c1e01);		// clb a,b
+		},
+		[&]()
+		{
+			assert(dsp.regs().b.var == 0xffffffea000000);
+			assert(dsp.sr_test(CCR_N));
+			assert(!dsp.sr_test(CCR_Z));
+			assert(!dsp.sr_test(CCR_V));
+		});
+
+		runTest([&](auto& _block, auto& _ops)
+		{
+			dsp.regs().b.var = 0x01000000000000;
+			_ops.emit(0, 0x0c1e02);		// clb b,a
+		},
+		[&]()
+		{
+			assert(dsp.regs().a.var == 0x00000002000000);
+			assert(!dsp.sr_test(CCR_N));
+			assert(!dsp.sr_test(CCR_Z));
+		});
+
+		runTest([&](auto& _block, auto& _ops)
+		{
+			dsp.regs().a.var = 0xffffffff000000;
+			_ops.emit(0, 0x0c1e01);		// clb a,b
+		},
+		[&]()
+		{
+			assert(dsp.regs().b.var == 0xffffffe9000000);
+		});
+
+		runTest([&](auto& _block, auto& _ops)
+		{
+			dsp.regs().a.var = 0xffffffffffffff;
+			_ops.emit(0, 0x0c1e01);		// clb a,b
+		},
+		[&]()
+		{
+			assert(dsp.regs().b.var == 0xffffffd1000000);
+		});
+
+		runTest([&](auto& _block, auto& _ops)
+		{
+			dsp.regs().a.var = 0x00400000000000;
+			dsp.regs().b.var = 0x12345678abcdef;
+			_ops.emit(0, 0x0c1e01);		// clb a,b
+		},
+		[&]()
+		{
+			assert(dsp.regs().b.var == 0);
+			assert(dsp.sr_test(CCR_Z));
+			assert(!dsp.sr_test(CCR_N));
+		});
+
+		runTest([&](auto& _block, auto& _ops)
+		{
+			dsp.regs().a.var = 0;
+			dsp.regs().b.var = 0x12345678abcdef;
+			_ops.emit(0, 0x0c1e01);		// clb a,b
+		},
+		[&]()
+		{
+			assert(dsp.regs().b.var == 0);
+			assert(dsp.sr_test(CCR_Z));
+		});
+	}
+
 	void JitUnittests::clr()
 	{
 		runTest([&](auto& _block, auto& _ops)
@@ -1328,6 +1517,48 @@ namespace dsp56k
 		});
 	}
 
+	void JitUnittests::cmpu()
+	{
+		runTest([&](auto& _block, auto& _ops)
+		{
+			dsp.regs().a.var = 0x00800000000000;
+			dsp.x0(0x400000);
+			_ops.emit(0, 0x0c1ff8);		// cmpu x0,a
+		},
+		[&]()
+		{
+			assert(!dsp.sr_test(CCR_C));
+			assert(!dsp.sr_test(CCR_Z));
+		});
+
+		runTest([&](auto& _block, auto& _ops)
+		{
+			// signed, x0 is negative, unsigned it is larger
+			dsp.regs().a.var = 0x00400000000000;
+			dsp.x0(0x800000);
+			_ops.emit(0, 0x0c1ff8);		// cmpu x0,a
+		},
+		[&]()
+		{
+			assert(dsp.sr_test(CCR_C));
+			assert(!dsp.sr_test(CCR_Z));
+		});
+
+		runTest([&](auto& _block, auto& _ops)
+		{
+			// the extension is ignored
+			dsp.regs().a.var = 0xff123456abcdef;
+			dsp.regs().b.var = 0x00123456abcdef;
+			_ops.emit(0, 0x0c1ff0);		// cmpu b,a
+		},
+		[&]()
+		{
+			assert(!dsp.sr_test(CCR_C));
+			assert(dsp.sr_test(CCR_Z));
+			assert(dsp.regs().a.var == 0xff123456abcdef);
+		});
+	}
+
 	void JitUnittests::dec()
 	{
 		runTest([&](auto& _block, auto& _ops)
@@ -1810,6 +2041,86 @@ namespace dsp56k
 		});
 	}
 
+	void JitUnittests::norm()
+	{
+		runTest([&](auto& _block, auto& _ops)
+		{
+			dsp.regs().a.var = 0x00100000000000;
+			dsp.regs().r[0].var = 5;
+			dsp.setSR((dsp.getSR().var & 0xffff00) | CCR_U);
+			_ops.emit(0, 0x01d815);		// norm r0,a
+		},
+		[&]()
+		{
+			assert(dsp.regs().a.var == 0x00200000000000);
+			assert(dsp.regs().r[0].var == 4);
+		});
+
+		runTest([&](auto& _block, auto& _ops)
+		{
+			dsp.regs().a.var = 0x01000000000000;
+			dsp.regs().r[0].var = 5;
+			dsp.setSR((dsp.getSR().var & 0xffff00) | CCR_E);
+			_ops.emit(0, 0x01d815);		// norm r0,a
+		},
+		[&]()
+		{
+			assert(dsp.regs().a.var == 0x00800000000000);
+			assert(dsp.regs().r[0].var == 6);
+		});
+
+		runTest([&](auto& _block, auto& _ops)
+		{
+			dsp.regs().a.var = 0;
+			dsp.regs().r[0].var = 5;
+			dsp.setSR((dsp.getSR().var & 0xffff00) | CCR_U | CCR_Z);
+			_ops.emit(0, 0x01d815);		// norm r0,a
+		},
+		[&]()
+		{
+			assert(dsp.regs().a.var == 0);
+			assert(dsp.regs().r[0].var == 5);
+		});
+	}
+
+	void JitUnittests::normf()
+	{
+		runTest([&](auto& _block, auto& _ops)
+		{
+			dsp.regs().a.var = 0x01000000000000;
+			dsp.x0(2);
+			_ops.emit(0, 0x0c1e28);		// normf x0,a
+		},
+		[&]()
+		{
+			assert(dsp.regs().a.var == 0x00400000000000);
+		});
+
+		runTest([&](auto& _block, auto& _ops)
+		{
+			dsp.regs().a.var = 0x00100000000000;
+			dsp.x0(0xfffffe);
+			_ops.emit(0, 0x0c1e28);		// normf x0,a
+		},
+		[&]()
+		{
+			assert(dsp.regs().a.var == 0x00400000000000);
+			assert(!dsp.sr_test(CCR_V));
+		});
+
+		runTest([&](auto& _block, auto& _ops)
+		{
+			// b1 is the result of clb a,b
+			dsp.regs().a.var = 0x00000001000000;
+			dsp.regs().b.var = 0xffffffea000000;
+			_ops.emit(0, 0x0c1e26);		// normf b1,a
+		},
+		[&]()
+		{
+			assert(dsp.regs().a.var == 0x00400000000000);
+		});
+	}
+
 	void JitUnittests::not_()
 	{
 		runTest([&](auto& _block, auto& _ops)
@@ -1963,6 +2274,29 @@ namespace dsp56k
 		});
 	}
 
+	void JitUnittests::wait()
+	{
+		runTest([&](JitBlock& _block, JitOps& _ops)
+		{
+			_ops.emit(0, 0x000086);	// wait
+		},
+		[&]()
+		{
+			assert(dsp.getPowerMode() == DSP::PowerWait);
+		});
+
+		runTest([&](JitBlock& _block, JitOps& _ops)
+		{
+			_ops.emit(0, 0x000087);	// stop
+		},
+		[&]()
+		{
+			assert(dsp.getPowerMode() == DSP::PowerStop);
+		});
+
+		dsp.m_powerMode = DSP::PowerNormal;
+	}
+
 	void JitUnittests::move()
 	{
 		// op_Mover
@@ -2522,6 +2856,39 @@ namespace dsp56k
 		{
 			assert(dsp.y1() == 0x8899aa);
 		});
+
+		// address registers set to an immediate value are used as compile time constant addresses
+		runTest([&](JitBlock& _block, JitOps& _ops)
+		{
+			dsp.regs().m[0].var = 0xffffff;
+			dsp.memory().set(MemArea_X, 0x10, 0x123456);
+			dsp.memory().set(MemArea_X, 0x11, 0x654321);
+			dsp.x0(0);
+			dsp.x1(0);
+			_ops.emit(0, 0x301000);	// move #$10,r0
+			_ops.emit(0, 0x44d800);	// move x:(r0)+,x0
+			_ops.emit(0, 0x45e000);	// move x:(r0),x1
+		},
+		[&]()
+		{
+			assert(dsp.regs().r[0].var == 0x11);
+			assert(dsp.x0() == 0x123456);
+			assert(dsp.x1() == 0x654321);
+		});
+
+		runTest([&](JitBlock& _block, JitOps& _ops)
+		{
+			dsp.regs().m[1].var = 0xffffff;
+			dsp.memory().set(MemArea_X, 0x20, 0);
+			dsp.x0(0xabcdef);
+			_ops.emit(0, 0x61f400, 0x000020);		// move #$20,r1
+			_ops.emit(0, 0x445100);					// move x0,x:(r1)-
+		},
+		[&]()
+		{
+			assert(dsp.regs().r[1].var == 0x1f);
+			assert(dsp.memory().get(MemArea_X, 0x20) == 0xabcdef);
+		});
 	}
 
 	void JitUnittests::parallel()
@@ -2643,6 +3010,168 @@ namespace dsp56k
 		});
 	}
 
+	void JitUnittests::interpretedOps()
+	{
+		// instructions without JIT implementation are run by the interpreter, it reads them from P memory
+		auto setP = [&](const TWord _op, const TWord _opB)
+		{
+			dsp.memory().set(MemArea_P, 0, _op);
+			dsp.memory().set(MemArea_P, 1, _opB);
+			dsp.notifyProgramMemWrite(0, 2);
+		};
+
+		runTest([&](JitBlock& _block, JitOps& _ops)
+		{
+			dsp.regs().a.var = 0x00112233445566;
+			setP(0x014582, 0);
+			_ops.emit(0, 0x014582);	// or #$5,a
+		},
+		[&]()
+		{
+			assert(dsp.regs().a.var == 0x00112237445566);
+			assert(!dsp.sr_test(CCR_N));
+			assert(!dsp.sr_test(CCR_Z));
+		});
+
+		runTest([&](JitBlock& _block, JitOps& _ops)
+		{
+			dsp.regs().b.var = 0x00123456abcdef;
+			setP(0x0140cb, 0xffffff);
+			_ops.emit(0, 0x0140cb, 0xffffff);	// eor #$ffffff,b
+		},
+		[&]()
+		{
+			assert(dsp.regs().b.var == 0x00edcba9abcdef);
+			assert(dsp.sr_test(CCR_N));
+		});
+
+		runTest([&](JitBlock& _block, JitOps& _ops)
+		{
+			dsp.regs().a.var = 0x00000003000000;
+			dsp.sr_set(CCR_C);
+			setP(0x200027, 0);
+			_ops.emit(0, 0x200027);	// ror a
+		},
+		[&]()
+		{
+			assert(dsp.regs().a.var == 0x00800001000000);
+			assert(dsp.sr_test(CCR_C));
+			assert(dsp.sr_test(CCR_N));
+			assert(!dsp.sr_test(CCR_Z));
+		});
+	}
+
+	void JitUnittests::idleLoop()
+	{
+		// A block that only polls a peripheral bit and jumps to itself is flagged as idle loop. Once it has been
+		// compiled, the batch is left instead of running it over and over again
+		auto& jit = dsp.getJit();
+
+		dsp.memory().set(MemArea_P, 0x30, 0x0a8380);	// jclr #0,x:$ffffc3,$30
+		dsp.memory().set(MemArea_P, 0x31, 0x000030);
+		dsp.setPC(0x30);
+
+		const auto count = jit.execFor(1000);
+
+		assert(count < 1000);
+		assert(dsp.getPowerMode() == DSP::PowerIdleLoop);
+		assert(dsp.getPC().var == 0x30);
+
+		dsp.m_powerMode = DSP::PowerNormal;
+
+		// polling HRX is not idle, every read pops the receive FIFO
+		dsp.memory().set(MemArea_P, 0x40, 0x0a8680);	// jclr #0,x:$ffffc6,$40
+		dsp.memory().set(MemArea_P, 0x41, 0x000040);
+		dsp.setPC(0x40);
+
+		jit.execFor(1000);
+
+		assert(dsp.getPowerMode() == DSP::PowerNormal);
+
+		dsp.setPC(0);
+	}
+
+	void JitUnittests::periphDirectAccess()
+	{
+		// JIT code reads TCPR directly, SAISR via its handler and the ID register as immediate. All of them need to
+		// return what read() returns
+		Peripherals56362 periph;
+		dsp.setPeriph(0, &periph);
+
+		periph.write(Timers::M_TCPR0, 0x123456);
+		periph.write(Esai::M_SAISR, 0x000000);
+
+		assert(periph.getDirectReadAccess(Timers::M_TCPR0).ptr);
+		assert(periph.getDirectReadAccess(Esai::M_SAISR).read);
+		assert(periph.getDirectReadAccess(0xfffff5).isConstant);
+
+		runTest([&](JitBlock& _block, JitOps& _ops)
+		{
+			const RegGP r(_block);
+
+			_block.mem().readPeriph(r, MemArea_X, TWord(Timers::M_TCPR0));
+			_block.mem().mov(m_checks[0], r);
+
+			_block.mem().readPeriph(r, MemArea_X, TWord(Esai::M_SAISR));
+			_block.mem().mov(m_checks[1], r);
+
+			_block.mem().readPeriph(r, MemArea_X, TWord(0xfffff5));
+			_block.mem().mov(m_checks[2], r);
+		},
+		[&]()
+		{
+			assert(m_checks[0] == periph.read(Timers::M_TCPR0));
+			assert(m_checks[1] == periph.read(Esai::M_SAISR));
+			assert(m_checks[2] == periph.read(0xfffff5));
+			assert(m_checks[2] == 0x362);
+		});
+
+		dsp.setPeriph(0, &peripherals);
+	}
+
+	void JitUnittests::codeBudget()
+	{
+		// Two blocks that branch to each other. A budget that is smaller than one block evicts the other block each
+		// time a block is installed, it has to be compiled and linked again when it is needed
+		auto& jit = dsp.getJit();
+
+		dsp.memory().set(MemArea_P, 0x20, 0x000008);	// inc a
+		dsp.memory().set(MemArea_P, 0x21, 0x0e8040);	// jcs $40
+		dsp.memory().set(MemArea_P, 0x22, 0x000009);	// inc b
+		dsp.memory().set(MemArea_P, 0x23, 0x0e0020);	// jcc $20
+
+		dsp.regs().a.var = 0;
+		dsp.regs().b.var = 0;
+		dsp.setSR(0xc00300);
+		dsp.setPC(0x20);
+
+		jit.resetStats();
+		jit.setCodeBudget(1);
+
+		dsp.runFor(1000);
+
+		const auto evicted = jit.getStats().evictedBlocks;
+		assert(evicted > 0);
+
+		auto a = dsp.regs().a.var;
+		auto b = dsp.regs().b.var;
+		assert(a >= 200 && (a == b || a == b + 1));
+
+		// without a budget, both blocks stay and are chained
+		jit.setCodeBudget(0);
+
+		dsp.runFor(1000);
+
+		assert(jit.getStats().evictedBlocks == evicted);
+
+		assert(dsp.regs().a.var >= a + 200);
+		a = dsp.regs().a.var;
+		b = dsp.regs().b.var;
+		assert(a == b || a == b + 1);
+
+		dsp.setPC(0);
+	}
+
 	void JitUnittests::ori_build(JitBlock& _block, JitOps& _ops)
 	{
 		dsp.regs().omr.var = 0xff1111;
@@ -49,6 +49,15 @@ namespace dsp56k
 		
 		void agu_modulo2_build(JitBlock& _block, JitOps& _ops);
 		void agu_modulo2_verify();
+
+		void agu_moduloConst_build(JitBlock& _block, JitOps& _ops);
+		void agu_moduloConst_verify();
+
+		void agu_multiWrapModulo_build(JitBlock& _block, JitOps& _ops);
+		void agu_multiWrapModulo_verify();
+
+		void agu_bitreverse_build(JitBlock& _block, JitOps& _ops);
+		void agu_bitreverse_verify();
 		
 		void transferSaturation_build(JitBlock& _block, JitOps& _ops);
 		void transferSaturation_verify();
@@ -127,8 +136,10 @@ namespace dsp56k
 		void btst_aa_build(JitBlock& _block, JitOps& _ops);
 		void btst_aa_verify();
 
+		void clb();
 		void clr();
 		void cmp();
+		void cmpu();
 		void dec();
 		void div();
 		void rep_div();
@@ -146,17 +157,28 @@ namespace dsp56k
 		void mpyr();
 		void mpy_SD();
 		void neg();
+		void norm();
+		void normf();
 		void not_();
 		void or_();
 		void rnd();
 		void rol();
 		void sub();
 		void tfr();
+		void wait();
 
 		void move();
 
 		void parallel();
 
+		void interpretedOps();
+
+		void idleLoop();
+
+		void periphDirectAccess();
+
+		void codeBudget();
+
 		void ori_build(JitBlock& _block, JitOps& _ops);
 		void ori_verify();
 
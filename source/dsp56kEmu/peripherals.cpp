@@ -1,5 +1,7 @@
 #include "peripherals.h"
 
+#include <algorithm>
+
 #include "aar.h"
 #include "disasm.h"
 #include "dsp.h"
@@ -22,45 +24,62 @@ namespace dsp56k
 	{
 //		LOG( "Periph read @ " << std::hex << _addr );
 
+		const auto a = getDirectReadAccess(_addr);
+
+		if(a.read)
+			return a.read(this);
+		if(a.isConstant)
+			return a.value;
+		return *a.ptr;
+	}
+
+	void Peripherals56303::write(TWord _addr, TWord _val)
+	{
+//		LOG( "Periph write @ " << std::hex << _addr );
+
+		const auto a = getDirectWriteAccess(_addr);
+
+		if(a.write)
+			a.write(this, _val);
+		else if(a.ptr)
+			*a.ptr = _val;
+	}
+
+	IPeripherals::DirectAccess Peripherals56303::getDirectReadAccess(const TWord _addr)
+	{
+		using P = Peripherals56303;
+
+		DirectAccess a;
+
 		switch (_addr)
 		{
-		case HI08::HSR:
-			return m_hi08.readStatusRegister();
-		case HI08::HRX:
-			return m_hi08.read();
-
-		case Essi::ESSI0_RX:
-			return m_essi.readRX(0);
-		case Essi::ESSI0_SSISR:
-			return m_essi.readSR();
+		case HI08::HSR:			a.read = [](IPeripherals* _p) { return static_cast<P*>(_p)->m_hi08.readStatusRegister(); }; a.pureRead = true;	break;
+		case HI08::HRX:			a.read = [](IPeripherals* _p) { return static_cast<P*>(_p)->m_hi08.read(); };					break;
+		case Essi::ESSI0_RX:	a.read = [](IPeripherals* _p) { return static_cast<P*>(_p)->m_essi.readRX(0); };				break;
+		case Essi::ESSI0_SSISR:	a.read = [](IPeripherals* _p) { return static_cast<P*>(_p)->m_essi.readSR(); };				break;
+		default:				a.ptr = &m_mem[_addr - XIO_Reserved_High_First];											break;
 		}
-		return m_mem[_addr - XIO_Reserved_High_First];
+
+		return a;
 	}
 
-	void Peripherals56303::write(TWord _addr, TWord _val)
+	IPeripherals::DirectAccess Peripherals56303::getDirectWriteAccess(const TWord _addr)
 	{
-//		LOG( "Periph write @ " << std::hex << _addr );
+		using P = Peripherals56303;
+
+		DirectAccess a;
 
 		switch (_addr)
 		{
-		case HI08::HSR:
-			m_hi08.writeStatusRegister(_val);
-			break;
-		case  Essi::ESSI0_SSISR:
-			m_essi.writeSR(_val);
-			return;
-		case  Essi::ESSI0_TX0:
-			m_essi.writeTX(0, _val);
-			return;
-		case  Essi::ESSI0_TX1:
-			m_essi.writeTX(1, _val);
-			return;
-		case  Essi::ESSI0_TX2:
-			m_essi.writeTX(2, _val);
-			return;
-		default:
-			m_mem[_addr - XIO_Reserved_High_First] = _val;
+		case HI08::HSR:			a.write = [](IPeripherals* _p, TWord _v) { static_cast<P*>(_p)->m_hi08.writeStatusRegister(_v); };	break;
+		case Essi::ESSI0_SSISR:	a.write = [](IPeripherals* _p, TWord _v) { static_cast<P*>(_p)->m_essi.writeSR(_v); };				break;
+		case Essi::ESSI0_TX0:	a.write = [](IPeripherals* _p, TWord _v) { static_cast<P*>(_p)->m_essi.writeTX(0, _v); };			break;
+		case Essi::ESSI0_TX1:	a.write = [](IPeripherals* _p, TWord _v) { static_cast<P*>(_p)->m_essi.writeTX(1, _v); };			break;
+		case Essi::ESSI0_TX2:	a.write = [](IPeripherals* _p, TWord _v) { static_cast<P*>(_p)->m_essi.writeTX(2, _v); };			break;
+		default:				a.ptr = &m_mem[_addr - XIO_Reserved_High_First];													break;
 		}
+
+		return a;
 	}
 
 	void Peripherals56303::exec()
@@ -80,151 +99,172 @@ namespace dsp56k
 
 	TWord Peripherals56362::read(TWord _addr)
 	{
-		switch (_addr)
+		const auto a = getDirectReadAccess(_addr);
+
+		if(a.ptr)
+			return *a.ptr;
+		if(a.read)
+			return a.read(this);
+		if(a.isConstant)
+			return a.value;
+
+		const auto value = m_mem[_addr - XIO_Reserved_High_First];
+
+		LOG( "Periph read @ " << std::hex << _addr << ": returning (0x" <<  HEX(value) << ")");
+
+		return value;
+	}
+
+	void Peripherals56362::write(TWord _addr, TWord _val)
+	{
+		const auto a = getDirectWriteAccess(_addr);
+
+		if(a.ptr)
 		{
-		case HDI08::HSR:
-			return m_hdi08.readStatusRegister();
-		case HDI08::HCR:
-			return m_hdi08.readControlRegister();
-		case HDI08::HPCR:
-			return m_hdi08.readPortControlRegister();
-		case HDI08::HORX:
-			return m_hdi08.readRX();
-
-		case Esai::M_RCR:
-			return m_esai.readReceiveControlRegister();
-		case Esai::M_SAISR:
-			return m_esai.readStatusRegister();
-		case Esai::M_TCR:
-			return m_esai.readTransmitControlRegister();
-		case Esai::M_RX0:
-		case Esai::M_RX1:
-		case Esai::M_RX2:
-		case Esai::M_RX3:
-			return m_esai.readRX(_addr - Esai::M_RX0);
-		case 0xFFFFBE:	// Port C Direction Register
-			return 0;
+			*a.ptr = _val;
+			return;
+		}
+		if(a.write)
+		{
+			a.write(this, _val);
+			return;
+		}
+		if(a.isConstant)
+			return;
 
-			
-		case Timers::M_TCSR0:		return m_timers.readTCSR(0);	// TIMER0 Control/Status Register
-		case Timers::M_TCSR1:		return m_timers.readTCSR(1);	// TIMER1 Control/Status Register
-		case Timers::M_TCSR2:		return m_timers.readTCSR(2);	// TIMER2 Control/Status Register
-		case Timers::M_TLR0:		return m_timers.readTLR	(0);	// TIMER0 Load Reg
-		case Timers::M_TLR1:		return m_timers.readTLR	(1);	// TIMER1 Load Reg
-		case Timers::M_TLR2:		return m_timers.readTLR	(2);	// TIMER2 Load Reg
-		case Timers::M_TCPR0:		return m_timers.readTCPR(0);	// TIMER0 Compare Register
-		case Timers::M_TCPR1:		return m_timers.readTCPR(1);	// TIMER1 Compare Register
-		case Timers::M_TCPR2:		return m_timers.readTCPR(2);	// TIMER2 Compare Register
-		case Timers::M_TCR0:		return m_timers.readTCR	(0);	// TIMER0 Count Register
-		case Timers::M_TCR1:		return m_timers.readTCR	(1);	// TIMER1 Count Register
-		case Timers::M_TCR2:		return m_timers.readTCR	(2);	// TIMER2 Count Register
-
-		case Timers::M_TPLR:		return m_timers.readTPLR();		// TIMER Prescaler Load Register
-		case Timers::M_TPCR:		return m_timers.readTPCR();		// TIMER Prescalar Count Register
+		LOG( "Periph write @ " << std::hex << _addr << ": 0x" << HEX(_val));
+		m_mem[_addr - XIO_Reserved_High_First] = _val;
+	}
 
-		case 0xffffff:
-		case 0xfffffe:
-			return m_mem[_addr - XIO_Reserved_High_First];
-		case 0xFFFF93:			// SHI__HTX
-		case 0xFFFF94:			// SHI__HRX
-//			LOG("Read from " << HEX(_addr));
-			return 0;	//m_mem[_addr - XIO_Reserved_High_First];	// There is nothing connected.
+	IPeripherals::DirectAccess Peripherals56362::getDirectReadAccess(const TWord _addr)
+	{
+		// registers that are not listed here are logged when being read
+		using P = Peripherals56362;
 
-		case 0xFFFFF4:					// DMA status reg
-			return 0x3f;
-		case 0xFFFFF5:					// ID Register
-			return 0x362;
+		DirectAccess a;
 
+		switch (_addr)
+		{
+		case HDI08::HSR:			a.read = [](IPeripherals* _p) { return static_cast<P*>(_p)->m_hdi08.readStatusRegister(); }; a.pureRead = true;	break;
+		case HDI08::HCR:			a.read = [](IPeripherals* _p) { return static_cast<P*>(_p)->m_hdi08.readControlRegister(); }; a.pureRead = true;	break;
+		case HDI08::HPCR:			a.read = [](IPeripherals* _p) { return static_cast<P*>(_p)->m_hdi08.readPortControlRegister(); }; a.pureRead = true;	break;
+		case HDI08::HORX:			a.read = [](IPeripherals* _p) { return static_cast<P*>(_p)->m_hdi08.readRX(); };					break;
+
+		// reading SAISR is remembered by the ESAI
+		case Esai::M_RCR:			a.read = [](IPeripherals* _p) { return static_cast<P*>(_p)->m_esai.readReceiveControlRegister(); }; a.pureRead = true;	break;
+		case Esai::M_SAISR:			a.read = [](IPeripherals* _p) { return static_cast<P*>(_p)->m_esai.readStatusRegister(); };			break;
+		case Esai::M_TCR:			a.read = [](IPeripherals* _p) { return static_cast<P*>(_p)->m_esai.readTransmitControlRegister(); }; a.pureRead = true;	break;
+		case Esai::M_RX0:			a.read = [](IPeripherals* _p) { return static_cast<P*>(_p)->m_esai.readRX(0); };					break;
+		case Esai::M_RX1:			a.read = [](IPeripherals* _p) { return static_cast<P*>(_p)->m_esai.readRX(1); };					break;
+		case Esai::M_RX2:			a.read = [](IPeripherals* _p) { return static_cast<P*>(_p)->m_esai.readRX(2); };					break;
+		case Esai::M_RX3:			a.read = [](IPeripherals* _p) { return static_cast<P*>(_p)->m_esai.readRX(3); };					break;
+
+		case Timers::M_TCSR0:		a.read = [](IPeripherals* _p) { return static_cast<P*>(_p)->m_timers.readTCSR(0); }; a.pureRead = true;	break;
+		case Timers::M_TCSR1:		a.read = [](IPeripherals* _p) { return static_cast<P*>(_p)->m_timers.readTCSR(1); }; a.pureRead = true;	break;
+		case Timers::M_TCSR2:		a.read = [](IPeripherals* _p) { return static_cast<P*>(_p)->m_timers.readTCSR(2); }; a.pureRead = true;	break;
+		case Timers::M_TLR0:		a.ptr = m_timers.getTLRPtr(0);		break;
+		case Timers::M_TLR1:		a.ptr = m_timers.getTLRPtr(1);		break;
+		case Timers::M_TLR2:		a.ptr = m_timers.getTLRPtr(2);		break;
+		case Timers::M_TCPR0:		a.ptr = m_timers.getTCPRPtr(0);		break;
+		case Timers::M_TCPR1:		a.ptr = m_timers.getTCPRPtr(1);		break;
+		case Timers::M_TCPR2:		a.ptr = m_timers.getTCPRPtr(2);		break;
+		case Timers::M_TCR0:		a.ptr = m_timers.getTCRPtr(0);		break;
+		case Timers::M_TCR1:		a.ptr = m_timers.getTCRPtr(1);		break;
+		case Timers::M_TCR2:		a.ptr = m_timers.getTCRPtr(2);		break;
+		case Timers::M_TPLR:		a.ptr = m_timers.getTPLRPtr();		break;
+		case Timers::M_TPCR:		a.ptr = m_timers.getTPCRPtr();		break;
+
+		case 0xFFFFBE:				// Port C Direction Register
+		case 0xFFFF93:				// SHI__HTX, there is nothing connected
+		case 0xFFFF94:				// SHI__HRX
+			a.isConstant = true;
+			a.value = 0;
+			break;
+		case 0xFFFFF4:				// DMA status reg
+			a.isConstant = true;
+			a.value = 0x3f;
+			break;
+		case 0xFFFFF5:				// ID Register
+			a.isConstant = true;
+			a.value = 0x362;
+			break;
+
+		case 0xffffff:
+		case 0xfffffe:
+		case 0xffffd5:
 		case M_AAR0:
 		case M_AAR1:
 		case M_AAR2:
 		case M_AAR3:
-			return m_mem[_addr - XIO_Reserved_High_First];
+			a.ptr = &m_mem[_addr - XIO_Reserved_High_First];
+			break;
+		default:
+			break;
 		}
 
-		auto& value = m_mem[_addr - XIO_Reserved_High_First];
-
-		if (_addr!=0xffffd5) {LOG( "Periph read @ " << std::hex << _addr << ": returning (0x" <<  HEX(value) << ")");}
-
-		return value;
+		return a;
 	}
 
-	void Peripherals56362::write(TWord _addr, TWord _val)
+	IPeripherals::DirectAccess Peripherals56362::getDirectWriteAccess(const TWord _addr)
 	{
+		// registers that are not listed here are logged when being written
+		using P = Peripherals56362;
+
+		DirectAccess a;
+
 		switch (_addr)
 		{
-		case HDI08::HSR:
-			m_hdi08.writeStatusRegister(_val);
-			return;
-		case HDI08::HCR:
-			m_hdi08.writeControlRegister(_val);
-			return;
-		case HDI08::HPCR:
-			m_hdi08.writePortControlRegister(_val);
-			return;
-		case HDI08::HOTX:
-			m_hdi08.writeTX(_val);
-			return;
-
-		case Timers::M_TCSR0:		m_timers.writeTCSR	(0, _val);	return;		// TIMER0 Control/Status Register
-		case Timers::M_TCSR1:		m_timers.writeTCSR	(1, _val);	return;		// TIMER1 Control/Status Register
-		case Timers::M_TCSR2:		m_timers.writeTCSR	(2, _val);	return;		// TIMER2 Control/Status Register
-		case Timers::M_TLR0:		m_timers.writeTLR	(0, _val);	return;		// TIMER0 Load Reg
-		case Timers::M_TLR1:		m_timers.writeTLR	(1, _val);	return;		// TIMER1 Load Reg
-		case Timers::M_TLR2:		m_timers.writeTLR	(2, _val);	return;		// TIMER2 Load Reg
-		case Timers::M_TCPR0:		m_timers.writeTCPR	(0, _val);	return;		// TIMER0 Compare Register
-		case Timers::M_TCPR1:		m_timers.writeTCPR	(1, _val);	return;		// TIMER1 Compare Register
-		case Timers::M_TCPR2:		m_timers.writeTCPR	(2, _val);	return;		// TIMER2 Compare Register
-		case Timers::M_TCR0:		m_timers.writeTCR	(0, _val);	return;		// TIMER0 Count Register
-		case Timers::M_TCR1:		m_timers.writeTCR	(1, _val);	return;		// TIMER1 Count Register
-		case Timers::M_TCR2:		m_timers.writeTCR	(2, _val);	return;		// TIMER2 Count Register
-
-		case Timers::M_TPLR:		m_timers.writeTPLR	(_val);		return;		// TIMER Prescaler Load Register
-		case Timers::M_TPCR:		m_timers.writeTPCR	(_val);		return;		// TIMER Prescalar Count Register
-		
-		case 0xFFFF91:			// SHI__HCSR
-				if (!_val) m_disableTimers=true;		// TODO: HACK to disable timers once we don't need them anymore
-				return;
-		case 0xFFFF93:			// SHI__HTX
-		case 0xFFFF94:			// SHI__HRX
-//			LOG("Write to " << HEX(_addr) << ": " << HEX(_val));
-//			m_mem[_addr - XIO_Reserved_High_First] = _val;	// Do not write!
-			return;
+		case HDI08::HSR:			a.write = [](IPeripherals* _p, TWord _v) { static_cast<P*>(_p)->m_hdi08.writeStatusRegister(_v); };		break;
+		case HDI08::HCR:			a.write = [](IPeripherals* _p, TWord _v) { static_cast<P*>(_p)->m_hdi08.writeControlRegister(_v); };		break;
+		case HDI08::HPCR:			a.write = [](IPeripherals* _p, TWord _v) { static_cast<P*>(_p)->m_hdi08.writePortControlRegister(_v); };	break;
+		case HDI08::HOTX:			a.write = [](IPeripherals* _p, TWord _v) { static_cast<P*>(_p)->m_hdi08.writeTX(_v); };					break;
+
+		case Timers::M_TCSR0:		a.write = [](IPeripherals* _p, TWord _v) { static_cast<P*>(_p)->m_timers.writeTCSR(0, _v); };				break;
+		case Timers::M_TCSR1:		a.write = [](IPeripherals* _p, TWord _v) { static_cast<P*>(_p)->m_timers.writeTCSR(1, _v); };				break;
+		case Timers::M_TCSR2:		a.write = [](IPeripherals* _p, TWord _v) { static_cast<P*>(_p)->m_timers.writeTCSR(2, _v); };				break;
+		case Timers::M_TLR0:		a.write = [](IPeripherals* _p, TWord _v) { static_cast<P*>(_p)->m_timers.writeTLR(0, _v); };				break;
+		case Timers::M_TLR1:		a.write = [](IPeripherals* _p, TWord _v) { static_cast<P*>(_p)->m_timers.writeTLR(1, _v); };				break;
+		case Timers::M_TLR2:		a.write = [](IPeripherals* _p, TWord _v) { static_cast<P*>(_p)->m_timers.writeTLR(2, _v); };				break;
+		case Timers::M_TCPR0:		a.ptr = m_timers.getTCPRPtr(0);		break;
+		case Timers::M_TCPR1:		a.ptr = m_timers.getTCPRPtr(1);		break;
+		case Timers::M_TCPR2:		a.ptr = m_timers.getTCPRPtr(2);		break;
+		case Timers::M_TCR0:		a.write = [](IPeripherals* _p, TWord _v) { static_cast<P*>(_p)->m_timers.writeTCR(0, _v); };				break;
+		case Timers::M_TCR1:		a.write = [](IPeripherals* _p, TWord _v) { static_cast<P*>(_p)->m_timers.writeTCR(1, _v); };				break;
+		case Timers::M_TCR2:		a.write = [](IPeripherals* _p, TWord _v) { static_cast<P*>(_p)->m_timers.writeTCR(2, _v); };				break;
+		case Timers::M_TPLR:		a.write = [](IPeripherals* _p, TWord _v) { static_cast<P*>(_p)->m_timers.writeTPLR(_v); };				break;
+		case Timers::M_TPCR:		a.write = [](IPeripherals* _p, TWord _v) { static_cast<P*>(_p)->m_timers.writeTPCR(_v); };				break;
+
+		case 0xFFFF91:				// SHI__HCSR
+			a.write = [](IPeripherals* _p, TWord _v) { if (!_v) static_cast<P*>(_p)->m_disableTimers = true; };
+			break;
+		case 0xFFFF93:				// SHI__HTX, there is nothing connected, do not write
+		case 0xFFFF94:				// SHI__HRX
+			a.isConstant = true;
+			break;
 
-		case Esai::M_SAISR:
-			m_esai.writestatusRegister(_val);
-			return;
-		case Esai::M_SAICR:
-			m_esai.writeControlRegister(_val);
-			return;
-		case Esai::M_RCR:
-			m_esai.writeReceiveControlRegister(_val);
-			return;
-		case Esai::M_RCCR:
-			m_esai.writeReceiveClockControlRegister(_val);
-			return;
-		case Esai::M_TCR:
-			m_esai.writeTransmitControlRegister(_val);
-			return;
-		case Esai::M_TCCR:
-			m_esai.writeTransmitClockControlRegister(_val);
-			return;
-		case Esai::M_TX0:
-		case Esai::M_TX1:
-		case Esai::M_TX2:
-		case Esai::M_TX3:
-		case Esai::M_TX4:
-		case Esai::M_TX5:
-			m_esai.writeTX(_addr - Esai::M_TX0, _val);
-			return;
-		
-		case 0xFFFFFD:	m_esai.updatePCTL(_val);
-			return;
+		case Esai::M_SAISR:			a.write = [](IPeripherals* _p, TWord _v) { static_cast<P*>(_p)->m_esai.writestatusRegister(_v); };				break;
+		case Esai::M_SAICR:			a.write = [](IPeripherals* _p, TWord _v) { static_cast<P*>(_p)->m_esai.writeControlRegister(_v); };				break;
+		case Esai::M_RCR:			a.write = [](IPeripherals* _p, TWord _v) { static_cast<P*>(_p)->m_esai.writeReceiveControlRegister(_v); };		break;
+		case Esai::M_RCCR:			a.write = [](IPeripherals* _p, TWord _v) { static_cast<P*>(_p)->m_esai.writeReceiveClockControlRegister(_v); };	break;
+		case Esai::M_TCR:			a.write = [](IPeripherals* _p, TWord _v) { static_cast<P*>(_p)->m_esai.writeTransmitControlRegister(_v); };		break;
+		case Esai::M_TCCR:			a.write = [](IPeripherals* _p, TWord _v) { static_cast<P*>(_p)->m_esai.writeTransmitClockControlRegister(_v); };	break;
+		case Esai::M_TX0:			a.write = [](IPeripherals* _p, TWord _v) { static_cast<P*>(_p)->m_esai.writeTX(0, _v); };						break;
+		case Esai::M_TX1:			a.write = [](IPeripherals* _p, TWord _v) { static_cast<P*>(_p)->m_esai.writeTX(1, _v); };						break;
+		case Esai::M_TX2:			a.write = [](IPeripherals* _p, TWord _v) { static_cast<P*>(_p)->m_esai.writeTX(2, _v); };						break;
+		case Esai::M_TX3:			a.write = [](IPeripherals* _p, TWord _v) { static_cast<P*>(_p)->m_esai.writeTX(3, _v); };						break;
+		case Esai::M_TX4:			a.write = [](IPeripherals* _p, TWord _v) { static_cast<P*>(_p)->m_esai.writeTX(4, _v); };						break;
+		case Esai::M_TX5:			a.write = [](IPeripherals* _p, TWord _v) { static_cast<P*>(_p)->m_esai.writeTX(5, _v); };						break;
+
+		case 0xFFFFFD:				a.write = [](IPeripherals* _p, TWord _v) { static_cast<P*>(_p)->m_esai.updatePCTL(_v); };						break;
+
+		case 0xffffd5:
+			a.ptr = &m_mem[_addr - XIO_Reserved_High_First];
+			break;
 		default:
 			break;
 		}
-		if (_addr!=0xffffd5) {LOG( "Periph write @ " << std::hex << _addr << ": 0x" << HEX(_val));}
-		m_mem[_addr - XIO_Reserved_High_First] = _val;
+
+		return a;
 	}
 
 	void Peripherals56362::exec()
@@ -349,6 +389,27 @@ namespace dsp56k
 		}
 	}
 
+	bool Peripherals56362::isIdle()
+	{
+		if(m_esai.isTransmitterEnabled() || m_hdi08.hasPendingInterrupts())
+			return false;
+
+		return m_disableTimers || !m_timers.isEnabled();
+	}
+
+	uint32_t Peripherals56362::getCyclesUntilNextEvent()
+	{
+		if(m_hdi08.hasPendingInterrupts())
+			return 0;
+
+		const auto cycles = m_esai.getCyclesUntilNextEvent();
+
+		if(m_disableTimers)
+			return cycles;
+
+		return std::min(cycles, m_timers.getCyclesUntilNextEvent());
+	}
+
 	void Peripherals56362::terminate()
 	{
 		m_hdi08.terminate();
@@ -75,6 +75,19 @@ namespace dsp56k
 	class IPeripherals
 	{
 	public:
+		// Describes how a register at a constant address is accessed. read() and write() are implemented on top of it,
+		// JIT code uses it to access registers without calling read() or write(). If nothing is set, the register is
+		// an unknown one that read() and write() log
+		struct DirectAccess
+		{
+			TWord* ptr = nullptr;							// plain register without side effects, loaded or stored directly
+			TWord (*read)(IPeripherals*) = nullptr;			// handler of the register, called without address decoding
+			void (*write)(IPeripherals*, TWord) = nullptr;
+			bool isConstant = false;						// reads always return value, writes are discarded
+			bool pureRead = false;							// read handler has no side effects, it only reflects the peripheral state
+			TWord value = 0;
+		};
+
 		virtual ~IPeripherals() = default;
 
 		void setDSP(DSP* _dsp)
@@ -94,6 +107,17 @@ namespace dsp56k
 		virtual void setSymbols(Disassembler& _disasm) = 0;
 		virtual void terminate() = 0;
 
+		// true if no peripheral is going to raise an interrupt as emulated time advances, used to let the DSP sleep in WAIT
+		virtual bool isIdle() = 0;
+
+		// number of DSP cycles that may pass before a peripheral raises an interrupt or changes its state. Used to skip
+		// emulated time while the DSP has nothing to do
+		virtual uint32_t getCyclesUntilNextEvent() = 0;
+
+		// called by the JIT at compile time, possibly on the compile thread
+		virtual DirectAccess getDirectReadAccess(TWord _addr) = 0;
+		virtual DirectAccess getDirectWriteAccess(TWord _addr) = 0;
+
 	private:
 		DSP* m_dsp = nullptr;
 	};
@@ -124,6 +148,12 @@ namespace dsp56k
 
 		void terminate() override {};
 
+		bool isIdle() override { return false; }
+		uint32_t getCyclesUntilNextEvent() override { return 0; }
+
+		DirectAccess getDirectReadAccess(TWord _addr) override;
+		DirectAccess getDirectWriteAccess(TWord _addr) override;
+
 	private:
 		Essi m_essi;
 		HI08 m_hi08;
@@ -155,6 +185,12 @@ namespace dsp56k
 
 		void terminate() override;
 
+		bool isIdle() override;
+		uint32_t getCyclesUntilNextEvent() override;
+
+		DirectAccess getDirectReadAccess(TWord _addr) override;
+		DirectAccess getDirectWriteAccess(TWord _addr) override;
+
 	private:
 		Esai m_esai;
 		HDI08 m_hdi08;
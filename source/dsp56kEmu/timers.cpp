@@ -4,6 +4,9 @@
 
 #include "timers.h"
 
+#include <algorithm>
+#include <limits>
+
 namespace dsp56k
 {
 	void Timers::exec()
@@ -32,6 +35,30 @@ namespace dsp56k
 		}
 	}
 
+	uint32_t Timers::getCyclesUntilNextEvent() const
+	{
+		// cycles that passed since the last exec() have not been counted yet
+		const auto elapsed = delta(m_peripherals.getDSP().getInstructionCounter(), m_lastClock);
+
+		uint32_t cycles = std::numeric_limits<uint32_t>::max();
+
+		for (const auto& t : m_timers)
+		{
+			if (!t.m_tcsr.test(Timer::M_TE))
+				continue;
+
+			// the counter is incremented before it is compared, the next compare or overflow is at least one cycle away
+			const auto toCompare = ((t.m_tcpr - t.m_tcr - 1) & 0xffffff) + 1;
+			const auto toOverflow = ((0 - t.m_tcr - 1) & 0xffffff) + 1;
+
+			const auto c = std::min(toCompare, toOverflow);
+
+			cycles = std::min(cycles, c > elapsed ? c - elapsed : 0);
+		}
+
+		return cycles;
+	}
+
 	void Timers::execTimer(Timer& _t, uint32_t _index) const
 	{
 		if (!_t.m_tcsr.test(Timer::M_TE))
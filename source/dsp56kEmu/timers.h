@@ -117,6 +117,20 @@ namespace dsp56k
 		TWord readTPLR()							{ return m_tplr; }
 		TWord readTPCR()							{ return m_tpcr; }
 
+		// storage of registers that are plain values, accessed directly by JIT code
+		TWord* getTLRPtr(int _index)				{ return &m_timers[_index].m_tlr; }
+		TWord* getTCPRPtr(int _index)				{ return &m_timers[_index].m_tcpr; }
+		TWord* getTCRPtr(int _index)				{ return &m_timers[_index].m_tcr; }
+		TWord* getTPLRPtr()							{ return &m_tplr; }
+		TWord* getTPCRPtr()							{ return &m_tpcr; }
+
+		bool isEnabled() const
+		{
+			return m_timers[0].m_tcsr.test(Timer::M_TE) || m_timers[1].m_tcsr.test(Timer::M_TE) || m_timers[2].m_tcsr.test(Timer::M_TE);
+		}
+
+		uint32_t getCyclesUntilNextEvent() const;
+
 	private:
 		template<Timer::TcsrBits B> static void timerFlagReset(const Bitfield<unsigned, Timer::TcsrBits, 22>& _tcsr, TWord& _val)
 		{
@@ -5,6 +5,9 @@
 #include "disasm.h"
 #include "dsp.h"
 #include "memory.h"
+#include "timers.h"
+
+#include <limits>
 
 namespace dsp56k
 {
@@ -30,11 +33,13 @@ namespace dsp56k
 		testLongMemoryMoves();
 		testDIV();
 		testROL();
+		testROR();
 		testNOT();
 		testEXTRACTU();
 		testEXTRACTU_CO();
 		testMPY();
 		testAgu();
+		testTimers();
 
 //		testDisassembler();		// will take a few minutes in debug, so commented out for now
 	}
@@ -485,6 +490,31 @@ namespace dsp56k
 		assert(dsp.sr_test(CCR_C) == 0);
 	}
 
+	void UnitTests::testROR()
+	{
+		dsp.sr_set(CCR_C);
+		dsp.reg.a.var = 0x00000003000000;
+
+		// ror a
+		execOpcode(0x200027);
+
+		assert(dsp.reg.a.var == 0x00800001000000);
+		assert(dsp.sr_test(CCR_C));
+		assert(dsp.sr_test(CCR_N));
+		assert(!dsp.sr_test(CCR_Z));
+
+		dsp.sr_clear(CCR_C);
+		dsp.reg.a.var = 0x12000001abcdef;
+
+		// ror a
+		execOpcode(0x200027);
+
+		assert(dsp.reg.a.var == 0x12000000abcdef);
+		assert(dsp.sr_test(CCR_C));
+		assert(!dsp.sr_test(CCR_N));
+		assert(dsp.sr_test(CCR_Z));
+	}
+
 	void UnitTests::testNOT()
 	{
 		dsp.reg.a.var = 0x12555555123456;
@@ -565,6 +595,20 @@ namespace dsp56k
 		r = 0xf00;
 		AGU::updateAddressRegister(r, 0x200, 0xfff, 0xfff, 0x100);
 		assert(r == 0x1100);
+
+		// multiple wrap-around modulo, modulo 16
+		r = 0x10e;
+		AGU::updateAddressRegister(r, 0x17, 0x800f, 0xf, 0);
+		assert(r == 0x105);
+
+		// bit reverse
+		r = 0x1000;
+		AGU::updateAddressRegister(r, 0x200, 0, 0, 0);
+		assert(r == 0x1200);
+		AGU::updateAddressRegister(r, 0x200, 0, 0, 0);
+		assert(r == 0x1100);
+		AGU::updateAddressRegister(r, -0x200, 0, 0, 0);
+		assert(r == 0x1200);
 	}
 
 	void UnitTests::testDisassembler()
@@ -656,4 +700,38 @@ namespace dsp56k
 		LOG("Disassembler Unit Tests completed");
 #endif
 	}
+
+	void UnitTests::testTimers()
+	{
+		Timers timers(peripherals);
+
+		// start counting at the current instruction counter
+		timers.exec();
+
+		// no timer is enabled, nothing is going to happen
+		assert(timers.getCyclesUntilNextEvent() == std::numeric_limits<uint32_t>::max());
+
+		timers.writeTCPR(0, 100);
+		timers.writeTCSR(0, 1 << Timer::M_TE);
+
+		assert(timers.readTCR(0) == 0);
+		assert(timers.getCyclesUntilNextEvent() == 100);
+
+		// cycles that passed since the last exec count as well
+		const auto before = dsp.getInstructionCounter();
+		for(auto i=0; i<10; ++i)
+			execOpcode(0x000000);	// nop
+		const auto elapsed = dsp.getInstructionCounter() - before;
+
+		assert(timers.getCyclesUntilNextEvent() == 100 - elapsed);
+
+		timers.exec();
+
+		assert(timers.readTCR(0) == elapsed);
+		assert(timers.getCyclesUntilNextEvent() == 100 - elapsed);
+
+		// the compare register has been passed, the next event is the overflow
+		timers.writeTCR(0, 200);
+		assert(timers.getCyclesUntilNextEvent() == 0x1000000 - 200);
+	}
 }
@@ -31,6 +31,7 @@ namespace dsp56k
 		void testLongMemoryMoves();
 		void testDIV();
 		void testROL();
+		void testROR();
 		void testNOT();
 		void testEXTRACTU();
 		void testEXTRACTU_CO();
@@ -38,6 +39,8 @@ namespace dsp56k
 
 		void testAgu();
 
+		void testTimers();
+
 		void testDisassembler();
 		
 		void execOpcode(uint32_t _op0, uint32_t _op1 = 0, bool _reset=false);
@@ -142,26 +142,26 @@ namespace dsp56k
 
 	static TUInt8 bitreverse8( TUInt8 a )
 	{
-		return	(a & 0x80 >> 7)
-			|	(a & 0x40 >> 5)
-			|	(a & 0x20 >> 3)
-			|	(a & 0x10 >> 1)
-			|	(a & 0x08 << 1)
-			|	(a & 0x04 << 3)
-			|	(a & 0x02 << 5)
-			|	(a & 0x01 << 7);
+		return	((a & 0x80) >> 7)
+			|	((a & 0x40) >> 5)
+			|	((a & 0x20) >> 3)
+			|	((a & 0x10) >> 1)
+			|	((a & 0x08) << 1)
+			|	((a & 0x04) << 3)
+			|	((a & 0x02) << 5)
+			|	((a & 0x01) << 7);
 	}
 
 	static TWord bitreverse24( TWord a )
 	{
-		const TWord temp =  (a & 0x808080 >> 7)
-						|	(a & 0x404040 >> 5)
-						|	(a & 0x202020 >> 3)
-						|	(a & 0x101010 >> 1)
-						|	(a & 0x080808 << 1)
-						|	(a & 0x040404 << 3)
-						|	(a & 0x020202 << 5)
-						|	(a & 0x010101 << 7);
+		const TWord temp =  ((a & 0x808080) >> 7)
+						|	((a & 0x404040) >> 5)
+						|	((a & 0x202020) >> 3)
+						|	((a & 0x101010) >> 1)
+						|	((a & 0x080808) << 1)
+						|	((a & 0x040404) << 3)
+						|	((a & 0x020202) << 5)
+						|	((a & 0x010101) << 7);
 
 		return ((temp & 0xff0000) >> 16) | (temp & 0x00ff00) | ((temp & 0x0000ff) << 16);
 	}